@@ -0,0 +1,90 @@
+#ifndef ANY_RADAR_H
+#define ANY_RADAR_H
+
+#include "Body.h"
+#include "Radar.h"
+#include "FrameArena.h"
+#include "Span.h"
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Type-erased radar for configurations chosen at run time. Holds any BasicRadar
+// instantiation, or the fully runtime-configured Radar, behind one virtual call
+// per step; the scan loop inside stays the wrapped type's own inlined loop.
+class AnyRadar
+{
+public:
+    template <typename RadarType,
+              typename = typename enable_if<!is_same<typename decay<RadarType>::type, AnyRadar>::value>::type>
+    AnyRadar(RadarType radar) : self(new Model<RadarType>(move(radar))) {}
+
+    // A moved-from AnyRadar holds nothing, copying it gives another empty one
+    AnyRadar(const AnyRadar &other) : self(other.self ? other.self->clone() : nullptr) {}
+    AnyRadar(AnyRadar &&other) = default;
+    AnyRadar &operator=(const AnyRadar &other)
+    {
+        self.reset(other.self ? other.self->clone() : nullptr);
+        return *this;
+    }
+    AnyRadar &operator=(AnyRadar &&other) = default;
+
+    void update(float dt) { self->update(dt); }
+    Span<const Detection> scan(const vector<Body> &targets, float current_time, FrameArena &arena)
+    {
+        return self->scan(targets, current_time, arena);
+    }
+
+    vector<float> get_pos() const { return self->get_pos(); }
+    float get_max_range() const { return self->get_max_range(); }
+    float getScanAngle() const { return self->getScanAngle(); }
+    const vector<Detection> &getDetections() const { return self->getDetections(); }
+
+    // The wrapped radar, or nullptr if it is of another type
+    template <typename RadarType>
+    RadarType *get()
+    {
+        Model<RadarType> *model = dynamic_cast<Model<RadarType> *>(self.get());
+        return model ? &model->radar : nullptr;
+    }
+
+private:
+    struct Concept
+    {
+        virtual ~Concept() {}
+        virtual Concept *clone() const = 0;
+        virtual void update(float dt) = 0;
+        virtual Span<const Detection> scan(const vector<Body> &targets, float current_time, FrameArena &arena) = 0;
+        virtual vector<float> get_pos() const = 0;
+        virtual float get_max_range() const = 0;
+        virtual float getScanAngle() const = 0;
+        virtual const vector<Detection> &getDetections() const = 0;
+    };
+
+    template <typename RadarType>
+    struct Model : Concept
+    {
+        explicit Model(RadarType radar) : radar(move(radar)) {}
+
+        Concept *clone() const override { return new Model(radar); }
+        void update(float dt) override { radar.update(dt); }
+        Span<const Detection> scan(const vector<Body> &targets, float current_time, FrameArena &arena) override
+        {
+            return radar.scan(targets, current_time, arena);
+        }
+        vector<float> get_pos() const override { return radar.get_pos(); }
+        float get_max_range() const override { return radar.get_max_range(); }
+        float getScanAngle() const override { return radar.getScanAngle(); }
+        const vector<Detection> &getDetections() const override { return radar.getDetections(); }
+
+        RadarType radar;
+    };
+
+    unique_ptr<Concept> self;
+};
+
+#endif
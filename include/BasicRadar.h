@@ -0,0 +1,175 @@
+#ifndef BASIC_RADAR_H
+#define BASIC_RADAR_H
+
+#include "BeamGeometry.h"
+#include "Body.h"
+#include "Radar.h"
+#include "RadarPolicies.h"
+#include "FrameArena.h"
+#include "Span.h"
+
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// Radar with its detection model, noise model and beam shape fixed at compile
+// time. Policies are plain members called from the scan loop, so a configuration
+// that cannot miss or has no noise compiles to a loop without those branches or
+// random draws. Detections follow the same rules as Radar: the target is measured
+// where the beam crossed it, and plots close to a live one are suppressed.
+//
+// Targets are planar Bodies, so Dim is fixed at 2 for now; the parameter keeps the
+// position type and the geometry in one place for when Body grows an altitude.
+template <typename DetectionModel, typename NoiseModel, typename BeamShape, int Dim = 2>
+class BasicRadar
+{
+    static_assert(Dim == 2, "targets are planar, only 2D radars are supported");
+
+public:
+    typedef array<float, Dim> Position;
+
+    BasicRadar(const Position &pos, float max_range,
+               const BeamShape &beam = BeamShape(),
+               const DetectionModel &detection = DetectionModel(),
+               const NoiseModel &noise = NoiseModel(),
+               unsigned seed = random_device{}())
+        : pos(pos),
+          max_range(max_range),
+          beam(beam),
+          detection(detection),
+          noise(noise),
+          generator(seed)
+    {
+    }
+
+    void update(float dt)
+    {
+        beam.update(dt);
+        step_dt = dt;
+        for (auto it = detections.begin(); it != detections.end();)
+        {
+            it->lifespan -= dt;
+            if (it->lifespan <= 0)
+                it = detections.erase(it);
+            else
+                it++;
+        }
+    }
+
+    // Scans all targets, records new detections and returns them as a view into
+    // arena memory (valid until the arena is reset)
+    Span<const Detection> scan(const vector<Body> &targets, float current_time, FrameArena &arena)
+    {
+        for (auto &d : detections)
+            d.detected = false;
+
+        Span<Detection> step_detections = arena.allocate<Detection>(targets.size());
+        size_t count = 0;
+
+        for (size_t i = 0; i < targets.size(); i++)
+        {
+            const float *p1 = targets[i].pos_data();
+            const float *vel = targets[i].vel_data();
+
+            float time_before_end;
+            float az0 = azimuthTo(p1[0] - vel[0] * step_dt, p1[1] - vel[1] * step_dt);
+            if (!beam.crossing(az0, azimuthTo(p1[0], p1[1]), time_before_end))
+                continue;
+
+            float x = p1[0] - vel[0] * time_before_end;
+            float y = p1[1] - vel[1] * time_before_end;
+            float distance = distanceTo(x, y);
+            if (distance >= max_range || !detection.detect(distance, generator))
+                continue;
+
+            Detection det;
+            det.detected = true;
+            det.distance = distance;
+            det.azimuth = azimuthTo(x, y);
+            det.radial_velocity = radialVelocity(x, y, vel[0], vel[1]);
+            det.timestamp = current_time - time_before_end;
+            det.target_id = i;
+            det.lifespan = 1.0f;
+            noise.apply(det, generator);
+
+            if (isNew(det))
+            {
+                detections.push_back(det);
+                step_detections[count++] = det;
+            }
+        }
+
+        return Span<const Detection>(step_detections.data(), count);
+    }
+
+    float distanceTo(float x, float y) const
+    {
+        float dx = x - pos[0];
+        float dy = y - pos[1];
+        return sqrt(dx * dx + dy * dy);
+    }
+
+    float azimuthTo(float x, float y) const
+    {
+        float deg = atan2(y - pos[1], x - pos[0]) * 180.0f / M_PI;
+        if (deg < 0.0f && deg > -180.0f)
+            deg += 360;
+        return deg;
+    }
+
+    float radialVelocity(float x, float y, float vx, float vy) const
+    {
+        float dx = x - pos[0];
+        float dy = y - pos[1];
+        float distance = sqrt(dx * dx + dy * dy);
+        if (distance < 0.001f)
+            return 0.0f;
+        float ux = dx / distance;
+        float uy = dy / distance;
+        return vx * ux + vy * uy;
+    }
+
+    vector<float> get_pos() const { return {pos.begin(), pos.end()}; }
+    float get_max_range() const { return max_range; }
+    float getScanAngle() const { return beam.center(); }
+    const vector<Detection> &getDetections() const { return detections; }
+
+    BeamShape &getBeam() { return beam; }
+    DetectionModel &getDetectionModel() { return detection; }
+    NoiseModel &getNoiseModel() { return noise; }
+
+private:
+    // Same duplicate rule as Radar::checkDetection
+    bool isNew(const Detection &det) const
+    {
+        for (const Detection &d : detections)
+            if (BeamGeometry::isDuplicate(det.distance - d.distance, det.azimuth - d.azimuth))
+                return false;
+        return true;
+    }
+
+    Position pos;
+    float max_range;
+    float step_dt = 0.0f;
+
+    BeamShape beam;
+    DetectionModel detection;
+    NoiseModel noise;
+
+    default_random_engine generator;
+    vector<Detection> detections;
+};
+
+// Configurations compiled into the library
+typedef BasicRadar<RadarPolicy::AlwaysDetect, RadarPolicy::NoNoise, RadarPolicy::SweptBeam> IdealRadar;
+typedef BasicRadar<RadarPolicy::FixedPd, RadarPolicy::GaussianNoise, RadarPolicy::SweptBeam> SurveillanceRadar;
+typedef BasicRadar<RadarPolicy::FixedPd, RadarPolicy::GaussianNoise, RadarPolicy::StaringBeam> StaringRadar;
+
+extern template class BasicRadar<RadarPolicy::AlwaysDetect, RadarPolicy::NoNoise, RadarPolicy::SweptBeam>;
+extern template class BasicRadar<RadarPolicy::FixedPd, RadarPolicy::GaussianNoise, RadarPolicy::SweptBeam>;
+extern template class BasicRadar<RadarPolicy::FixedPd, RadarPolicy::GaussianNoise, RadarPolicy::StaringBeam>;
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef BEAM_GEOMETRY_H
+#define BEAM_GEOMETRY_H
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// Beam and plot rules shared by Radar and the BasicRadar policies, so the
+// runtime and compile-time radars cannot drift apart.
+namespace BeamGeometry
+{
+    // A new plot this close to a live one is the same return seen again
+    const float DUPLICATE_DISTANCE = 2.5f; // m
+    const float DUPLICATE_AZIMUTH = 1.5f;  // deg
+
+    // Wraps an angle difference into [-180, 180)
+    inline float wrap180(float deg)
+    {
+        deg = fmod(deg + 180.0f, 360.0f);
+        if (deg < 0)
+            deg += 360.0f;
+        return deg - 180.0f;
+    }
+
+    inline bool isDuplicate(float distance_delta, float azimuth_delta,
+                            float distance_threshold = DUPLICATE_DISTANCE,
+                            float azimuth_threshold = DUPLICATE_AZIMUTH)
+    {
+        return fabs(distance_delta) <= distance_threshold && fabs(azimuth_delta) <= azimuth_threshold;
+    }
+
+    // Whether a beam sweeping sweep_deg from sweep_start over the last step_dt
+    // crossed a target whose bearing moved from az0 to az1, and if so how long
+    // before the end of the step it crossed the beam center. beam_angle is the
+    // beam center at the end of the step
+    inline bool sweepCrossing(float az0, float az1, float sweep_start, float sweep_deg, float beam_angle,
+                              float half_beam, float step_dt, float &time_before_end)
+    {
+        // Rate at which the beam center closes on the target, deg/s
+        float closing_rate = step_dt > 0 ? (sweep_deg - wrap180(az1 - az0)) / step_dt : 0.0f;
+
+        if (closing_rate <= 0)
+        {
+            // Beam not moving relative to the target, only the end of step counts
+            time_before_end = 0;
+            return fabs(wrap180(az1 - beam_angle)) <= half_beam;
+        }
+
+        // The target sits ahead of the beam center by `ahead` (or just behind it, by
+        // ahead - 360) at the start of the step, and the gap shrinks linearly
+        float ahead = fmod(az0 - sweep_start, 360.0f);
+        if (ahead < 0)
+            ahead += 360.0f;
+
+        float best_enter = step_dt + 1;
+        float crossing = 0;
+        for (float rel0 : {ahead - 360.0f, ahead})
+        {
+            float enter = max((rel0 - half_beam) / closing_rate, 0.0f);
+            float exit = min((rel0 + half_beam) / closing_rate, step_dt);
+            if (enter <= exit && enter < best_enter)
+            {
+                best_enter = enter;
+                crossing = min(max(rel0 / closing_rate, enter), exit);
+            }
+        }
+
+        if (best_enter > step_dt)
+            return false;
+        time_before_end = step_dt - crossing;
+        return true;
+    }
+}
+
+#endif
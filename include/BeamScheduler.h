@@ -0,0 +1,73 @@
+#ifndef BEAM_SCHEDULER_H
+#define BEAM_SCHEDULER_H
+
+#include "Body.h"
+#include "Radar.h"
+#include "FrameArena.h"
+#include "Span.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+enum class ScanMode
+{
+    FULL,        // every target is tested against every radar each step
+    EVENT_DRIVEN // only targets the beam is predicted to reach are tested
+};
+
+// Event-driven scan scheduling. For each (radar, target) pair it predicts when
+// the rotating beam will next reach the target and keeps that in a per-radar
+// min-heap, so a step only evaluates the targets whose events are due instead
+// of all of them.
+//
+// Predictions assume the target keeps its velocity. Far-off predictions are
+// shortened so they get refined as the crossing approaches, more so for fast or
+// accelerating targets close to the radar, and invalidate() reschedules a target
+// immediately when it manoeuvres.
+class BeamScheduler
+{
+public:
+    BeamScheduler();
+
+    // Drops all events, every target is re-evaluated on the next step
+    void clear();
+    void invalidate(size_t target);
+
+    // Evaluates the due targets of one radar for the step ending at current_time
+    // and schedules their next events. Call after the radar and targets were updated
+    Span<const Detection> scan(size_t radar_index, Radar &radar, const vector<Body> &targets,
+                               float current_time, FrameArena &arena);
+
+    // Targets evaluated so far, for comparing against a full scan
+    uint64_t getEvaluations() const { return evaluations; }
+
+private:
+    struct Event
+    {
+        float time;
+        uint32_t target;
+        uint32_t generation;
+
+        // Reversed so the standard max-heap algorithms pop the earliest event
+        bool operator<(const Event &other) const { return time > other.time; }
+    };
+
+    // Shrinks long-range predictions, the linear prediction drifts for targets
+    // that are not moving tangentially at a constant rate
+    static constexpr float REFINE_FACTOR = 0.8f;
+
+    // Makes room for radar_count radars and target_count targets
+    void sync(size_t radar_count, size_t target_count);
+    void schedule(size_t radar_index, uint32_t target, float time);
+
+    vector<vector<Event>> queues;     // one heap per radar
+    vector<uint32_t> generations;     // per target, bumped by invalidate()
+    vector<uint32_t> due;             // scratch list of targets to evaluate
+    size_t known_targets;
+
+    uint64_t evaluations;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #ifndef BODY_H
 #define BODY_H
+#include <array>
 #include <vector>
 #include <ostream>
 
@@ -13,16 +14,24 @@ public:
     void update(float dt);
     void update(float dt, std::vector<float> accel);
 
-    std::vector<float> get_pos() const { return pos; }
-    std::vector<float> get_vel() const { return vel; }
-    std::vector<float> get_accel() const { return accel; }
+    std::vector<float> get_pos() const { return {pos.begin(), pos.end()}; }
+    std::vector<float> get_vel() const { return {vel.begin(), vel.end()}; }
+    std::vector<float> get_accel() const { return {accel.begin(), accel.end()}; }
+
+    // Non-copying access, state is stored inline so a vector<Body> is one
+    // contiguous block with a stride of sizeof(Body)
+    const float *pos_data() const { return pos.data(); }
+    const float *vel_data() const { return vel.data(); }
+    const float *accel_data() const { return accel.data(); }
 
     friend std::ostream& operator<<(std::ostream& os, const Body& body);
     
 private:
-    std::vector<float> pos;
-    std::vector<float> vel;
-    std::vector<float> accel;
+    std::array<float, 2> pos;
+    std::array<float, 2> vel;
+    std::array<float, 2> accel;
+
+    static std::array<float, 2> to_array(const std::vector<float> &values);
 };
 
 #endif
\ No newline at end of file
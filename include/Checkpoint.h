@@ -0,0 +1,50 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Body.h"
+#include "Radar.h"
+#include "SignalProcessor.h"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Binary snapshot of the whole simulation state: targets, every radar
+// (scan angle, live detections, RNG state), the signal models (waveform and
+// receiver noise state) and the sim clock.
+// The encoded buffer is immutable and shared, so copying a checkpoint is cheap
+// and the same checkpoint can be restored any number of times to fork runs.
+class Checkpoint
+{
+public:
+    Checkpoint();
+
+    static Checkpoint capture(const vector<Radar> &radars, const vector<Body> &targets, float sim_time);
+    // signal_models is indexed like radars, null where a radar detects geometrically
+    static Checkpoint capture(const vector<Radar> &radars, const vector<Body> &targets, float sim_time,
+                              const vector<unique_ptr<SignalProcessor>> &signal_models);
+    // Fails if the checkpoint holds signal models, they would be lost
+    bool restore(vector<Radar> &radars, vector<Body> &targets, float &sim_time) const;
+    // signal_models comes back sized like radars
+    bool restore(vector<Radar> &radars, vector<Body> &targets, float &sim_time,
+                 vector<unique_ptr<SignalProcessor>> &signal_models) const;
+
+    // Writes the snapshot on a background thread, stepping can continue meanwhile
+    future<bool> saveAsync(const string &path) const;
+    bool save(const string &path) const;
+    // Reads the whole file with a single bulk read
+    static bool load(const string &path, Checkpoint &checkpoint);
+
+    bool empty() const { return !data || data->empty(); }
+    size_t size() const { return data ? data->size() : 0; }
+
+private:
+    explicit Checkpoint(shared_ptr<const vector<char>> data);
+
+    shared_ptr<const vector<char>> data;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef DETECTION_HISTORY_H
+#define DETECTION_HISTORY_H
+
+#include "Radar.h"
+#include "Span.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Quantization steps of one radar's history. Errors after a round trip are at
+// most half a step, so steps well below the measurement noise lose nothing
+struct HistoryResolution
+{
+    float range = 0.05f;     // m
+    float azimuth = 0.01f;   // deg
+    float velocity = 0.05f;  // m/s
+    float time = 0.001f;     // s
+
+    // A quarter of the radar's measurement noise; noise-free fields keep the defaults
+    static HistoryResolution forRadar(const Radar &radar);
+};
+
+// Long-duration detection history in compact, quantized form.
+//
+// Each radar's detections are kept in time-ordered blocks of up to BLOCK_SIZE.
+// Every field is quantized to an integer on the radar's resolution and stored
+// as an offset from the block's minimum, in the narrowest of 1, 2, 4 or 8 bytes
+// that holds the block's spread. Fields are laid out one after the other, so a
+// block decodes as five independent widen-scale-add loops with no dependency
+// between records, which the compiler vectorizes. A detection typically takes
+// 9-10 bytes instead of sizeof(Detection).
+//
+// Blocks record their time span, and since appends are in time order the spans
+// are sorted, so a time-window query binary searches to the first block and only
+// decodes the blocks that overlap the window.
+class DetectionHistory
+{
+public:
+    static const size_t BLOCK_SIZE = 256;
+
+    // Returns the radar's index in the history
+    size_t addRadar(const HistoryResolution &resolution = HistoryResolution());
+
+    // Appends one step's detections of a radar. They are sorted by time first;
+    // successive batches are expected not to go back in time (a radar's steps don't)
+    void append(size_t radar, Span<const Detection> detections);
+    // Seals the partially filled blocks, they stay queryable either way
+    void flush();
+
+    // Appends the radar's detections with timestamp in [t0, t1] to out, in time
+    // order, returns how many. Decoded detections have detected = true, lifespan 0
+    // and azimuth wrapped into [0, 360)
+    size_t query(size_t radar, float t0, float t1, vector<Detection> &out) const;
+
+    size_t getRadarCount() const { return radars.size(); }
+    // Detections stored for the radar / for all radars
+    size_t size(size_t radar) const;
+    size_t size() const;
+    // Bytes used by encoded blocks, block headers and open blocks
+    size_t bytes() const;
+
+private:
+    enum Field
+    {
+        TIME,
+        RANGE,
+        AZIMUTH,
+        VELOCITY,
+        TARGET,
+        FIELD_COUNT
+    };
+
+    // Encoded blocks go into fixed-size pages, so a long run never reallocates and
+    // copies what it has already stored
+    static const size_t PAGE_SIZE = 64 * 1024;
+
+    struct Block
+    {
+        float t_min;
+        float t_max;
+        uint32_t count;
+        uint32_t page;
+        uint32_t offset; // bytes into the page
+        int64_t base[FIELD_COUNT];
+        uint8_t width[FIELD_COUNT];
+    };
+
+    struct RadarHistory
+    {
+        HistoryResolution resolution;
+        vector<Block> blocks;
+        vector<vector<uint8_t>> pages;
+        // Quantized records of the block being filled, one array per field
+        vector<int64_t> open[FIELD_COUNT];
+        float open_t_min = 0;
+        float open_t_max = 0;
+        size_t sealed_count = 0;
+    };
+
+    // Decoded block, one array per field
+    struct Columns
+    {
+        float time[BLOCK_SIZE];
+        float range[BLOCK_SIZE];
+        float azimuth[BLOCK_SIZE];
+        float velocity[BLOCK_SIZE];
+        int32_t target[BLOCK_SIZE];
+    };
+
+    void seal(RadarHistory &history);
+    static void decode(const RadarHistory &history, const Block &block, Columns &columns);
+    static void decodeOpen(const RadarHistory &history, Columns &columns);
+    static size_t emit(const Columns &columns, size_t count, float t0, float t1, vector<Detection> &out);
+
+    vector<RadarHistory> radars;
+    vector<Detection> sorted; // reused by append
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include "Span.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// Bump allocator for data that only lives for one simulation step.
+// Allocations are released all at once by reset(). If a step needs more than
+// the current capacity the excess goes to overflow chunks, and the next reset()
+// grows the main block to the high-water mark, so a steady-state step never
+// touches the heap.
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t capacity = 64 * 1024);
+
+    template <typename T>
+    Span<T> allocate(size_t count)
+    {
+        static_assert(is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        if (count == 0)
+            return Span<T>();
+        T *ptr = static_cast<T *>(allocateBytes(count * sizeof(T), alignof(T)));
+        for (size_t i = 0; i < count; i++)
+            new (ptr + i) T();
+        return Span<T>(ptr, count);
+    }
+
+    void reset();
+
+    size_t used() const { return used_bytes; }
+    size_t capacity() const { return block_size; }
+
+private:
+    void *allocateBytes(size_t size, size_t align);
+
+    unique_ptr<char[]> block;
+    size_t block_size;
+    size_t offset;
+
+    vector<unique_ptr<char[]>> overflow;
+    size_t used_bytes;
+    size_t high_water;
+};
+
+#endif
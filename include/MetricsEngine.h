@@ -0,0 +1,171 @@
+#ifndef METRICS_ENGINE_H
+#define METRICS_ENGINE_H
+
+#include "Body.h"
+#include "Radar.h"
+#include "Simulation.h"
+#include "Span.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Running mean, spread and worst case of an error, in constant memory (Welford)
+struct ErrorStats
+{
+    uint64_t count = 0;
+    double mean = 0;
+    double m2 = 0;
+    double max_abs = 0;
+
+    void add(double error);
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    double stddev() const;
+    double rms() const;
+};
+
+struct MetricsConfig
+{
+    float range_bin = 10.0f;   // width of the Pd range bins, m
+    float cutoff = 10.0f;      // OSPA/GOSPA cutoff c, m
+    float order = 2.0f;        // OSPA/GOSPA order p
+    unsigned threads = 4;      // radars are evaluated on up to this many threads
+    unsigned min_parallel_radars = 4; // fewer radars are evaluated on the calling thread
+};
+
+struct RadarMetrics
+{
+    // Measured minus true, bearing wrapped to [-180, 180)
+    ErrorStats range;
+    ErrorStats bearing;
+    ErrorStats radial_velocity;
+
+    // Per range bin: beam passes over a target in coverage, and how many of
+    // those produced a detection of that target
+    vector<uint64_t> opportunities;
+    vector<uint64_t> hits;
+    // Detections not associated with any target
+    uint64_t false_plots = 0;
+
+    double pd(size_t bin) const { return opportunities[bin] ? (double)hits[bin] / opportunities[bin] : 0.0; }
+};
+
+// Position estimate of a track, scored against the truth with OSPA and GOSPA
+struct TrackEstimate
+{
+    float x, y;
+};
+
+// GOSPA split into its parts, p-th powers summed over scored scans
+struct GospaTotals
+{
+    double localization = 0;
+    uint64_t missed = 0;
+    uint64_t false_tracks = 0;
+};
+
+// Scores detections against ground truth while the simulation runs.
+//
+// Every step, each new detection is joined with the true state of its target at
+// the detection timestamp (the target is moved back along its velocity from the
+// end of the step, the same exact path the radar measured on), and the range,
+// bearing and radial-velocity errors go into running statistics. Pd is counted
+// per range bin and beam pass: a pass lasts as long as the target stays in the
+// swept beam, and it is a hit if any step of it detected the target. State is
+// fixed-size accumulators plus one pass slot per radar and target, so memory
+// does not grow with run length, and radars are independent, so they are
+// evaluated in parallel on worker threads that live as long as the engine.
+class MetricsEngine
+{
+public:
+    explicit MetricsEngine(const MetricsConfig &config = MetricsConfig());
+    ~MetricsEngine();
+
+    MetricsEngine(const MetricsEngine &) = delete;
+    MetricsEngine &operator=(const MetricsEngine &) = delete;
+
+    // Evaluates the step the simulation just took
+    bool evaluate(const Simulation &simulation);
+    // Same, for callers that run their own loop. detections[r] are radar r's new
+    // detections of the step that ended at current_time. Fails, evaluating
+    // nothing, unless there is one detection span per radar
+    bool evaluate(const vector<Radar> &radars, const vector<Body> &targets,
+                  Span<const Span<const Detection>> detections, float current_time);
+
+    // Scores one scan of track estimates against the true positions at the same time.
+    // Returns the OSPA distance, GOSPA of the scan is available from getLastGospa()
+    double scoreTracks(Span<const TrackEstimate> tracks, const vector<Body> &truth);
+
+    void reset();
+
+    const MetricsConfig &getConfig() const { return config; }
+    size_t getRadarCount() const { return radars.size(); }
+    const RadarMetrics &getRadar(size_t radar) const { return radars[radar]; }
+    const ErrorStats &getOspa() const { return ospa; }
+    const ErrorStats &getGospa() const { return gospa; }
+    double getLastOspa() const { return last_ospa; }
+    double getLastGospa() const { return last_gospa; }
+    const GospaTotals &getGospaTotals() const { return gospa_totals; }
+
+    // Human-readable summary for acceptance reports
+    void report(ostream &out) const;
+
+private:
+    void evaluateRadar(size_t index, const Radar &radar, const vector<Body> &targets,
+                       Span<const Detection> detections, float current_time);
+
+    // Runs job(0 .. chunks - 1), chunk 0 on the calling thread and the others on
+    // the workers, which are started on first use and then wait for the next step
+    void runChunks(size_t chunks, const function<void(size_t)> &job);
+    void workerLoop(size_t chunk);
+
+    // Minimum cost assignment of every row of a rows x cols matrix (rows <= cols)
+    // to a distinct column, Hungarian method. Fills assignment, returns the cost
+    double assign(size_t rows, size_t cols);
+
+    MetricsConfig config;
+    vector<RadarMetrics> radars;
+    // Beam pass in progress of one radar over one target
+    struct Pass
+    {
+        int32_t bin = -1; // range bin where the pass started, -1 if not in the beam
+        bool hit = false;
+    };
+
+    // Per radar, indexed by target
+    vector<vector<Pass>> passes;
+    // Reused between steps: per radar, target ids detected in the step
+    vector<vector<uint32_t>> detected_ids;
+    vector<Span<const Detection>> step_views;
+
+    ErrorStats ospa;
+    ErrorStats gospa;
+    GospaTotals gospa_totals;
+    double last_ospa;
+    double last_gospa;
+
+    vector<thread> workers;
+    mutex pool_mutex;
+    condition_variable work_ready;
+    condition_variable work_done;
+    const function<void(size_t)> *pool_job = nullptr;
+    size_t pool_chunks = 0;
+    uint64_t pool_generation = 0;
+    size_t pool_pending = 0;
+    bool pool_stopping = false;
+
+    // Reused assignment buffers
+    vector<double> cost;
+    vector<double> u, v, minv;
+    vector<size_t> match, way;
+    vector<size_t> assignment;
+    vector<char> used;
+};
+
+#endif
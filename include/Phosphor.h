@@ -0,0 +1,53 @@
+#ifndef PHOSPHOR_H
+#define PHOSPHOR_H
+
+#include "Radar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+// Arithmetic of the viewer's phosphor PPI layer, kept free of SFML so it can be
+// tested without a window.
+namespace Phosphor
+{
+    // World position of a return, where the radar measured it rather than where
+    // the target truly is
+    inline void returnPosition(float radar_x, float radar_y, const Detection &det, float &x, float &y)
+    {
+        float rad = det.azimuth * M_PI / 180.0f;
+        x = radar_x + det.distance * cos(rad);
+        y = radar_y + det.distance * sin(rad);
+    }
+
+    // Per-frame subtractive decay. Subtracting reaches exact black, a
+    // multiplicative decay would leave 8-bit residue glowing forever. Fractions
+    // of a level carry over to the next frame, so a full-brightness return
+    // fades out in persistence seconds whatever the frame time
+    class Decay
+    {
+    public:
+        Decay(float persistence = 3.0f) : persistence(persistence), fade(0.0f) {}
+
+        // Levels to subtract this frame
+        uint8_t advance(float dt)
+        {
+            fade += 255.0f * dt / persistence;
+            uint8_t level = static_cast<uint8_t>(min(fade, 255.0f));
+            // A full level already reaches black, nothing is owed beyond that
+            fade = min(fade - level, 1.0f);
+            return level;
+        }
+
+        void reset() { fade = 0.0f; }
+        float getPersistence() const { return persistence; }
+
+    private:
+        float persistence; // seconds for a full-brightness return to fade out
+        float fade;        // fractional decay carried over between frames
+    };
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef PLOT_PUBLISHER_H
+#define PLOT_PUBLISHER_H
+
+#include "Radar.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+using namespace std;
+
+// Binary plot message, one data block per datagram, all fields big-endian:
+//
+//   block:  CAT u8 | LEN u16 (whole block, bytes) | RADAR u16 | record * n
+//   record: TARGET u16 | TIME u24 (1/128 s) | RHO u24 (1/128 m) |
+//           THETA u16 (360/2^16 deg) | VR i16 (1/16 m/s)
+//
+// The layout follows the ASTERIX data block idea (category, length, source id,
+// fixed-point fields) but uses a private category and a fixed record.
+namespace PlotFormat
+{
+    const uint8_t CATEGORY = 240;
+    const size_t HEADER_SIZE = 5;
+    const size_t RECORD_SIZE = 12;
+    const size_t MAX_BLOCK_SIZE = 1400; // stays under a typical Ethernet MTU
+    const size_t MAX_RECORDS = (MAX_BLOCK_SIZE - HEADER_SIZE) / RECORD_SIZE;
+    const uint16_t UNKNOWN_TARGET = 0xFFFF;
+
+    // Encodes count detections (count <= MAX_RECORDS) into out, returns the block size
+    size_t encode(uint16_t radar_id, const Detection *detections, size_t count, uint8_t *out);
+    // Decodes one block, appending to out, returns false on a malformed block
+    bool decode(const uint8_t *data, size_t size, uint16_t &radar_id, vector<Detection> &out);
+}
+
+// Publishes detections as binary plot messages over UDP or a Unix datagram socket.
+// publish() is called from the simulation thread and only copies into a
+// preallocated lock-free queue; an I/O thread encodes and sends the plots in
+// batches with sendmmsg. Nothing is allocated once the publisher is open.
+class PlotPublisher
+{
+public:
+    explicit PlotPublisher(size_t queue_capacity = 16384);
+    ~PlotPublisher();
+
+    // Opening again replaces the previous endpoint, but not while started
+    bool openUdp(const string &host, uint16_t port);
+    bool openUnix(const string &path);
+    // Accepts "udp:HOST:PORT" or "unix:PATH"
+    bool open(const string &endpoint);
+
+    void start();
+    // Flushes what is already queued, then joins the I/O thread
+    void stop();
+
+    // Returns false if the queue was full and the plot was dropped
+    bool publish(uint16_t radar_id, const Detection &detection);
+    size_t publish(uint16_t radar_id, const Detection *detections, size_t count);
+
+    uint64_t getSentPlots() const { return sent_plots.load(); }
+    uint64_t getSentDatagrams() const { return sent_datagrams.load(); }
+    uint64_t getDroppedPlots() const { return dropped_plots.load(); }
+
+private:
+    struct Plot
+    {
+        uint16_t radar_id;
+        Detection detection;
+    };
+
+    static const size_t MAX_DATAGRAMS = 64;
+    // How long a send waits for room in a full socket buffer before dropping
+    static const int SEND_TIMEOUT_MS = 100;
+
+    // Closes the current socket, fails while the I/O thread runs
+    bool release();
+    void run();
+    // Encodes count plots into datagrams and sends them, returns false on a send error
+    bool send(const Plot *plots, size_t count);
+    // Sends the first datagrams encoded blocks with sendmmsg
+    bool flush(size_t datagrams);
+
+    SpscQueue<Plot> queue;
+    thread io_thread;
+    atomic<bool> running;
+
+    int fd;
+    sockaddr_storage address;
+    socklen_t address_len;
+
+    // Preallocated send state, only touched by the I/O thread
+    vector<Plot> pending;
+    vector<uint8_t> buffers;
+    vector<iovec> iovecs;
+    vector<mmsghdr> messages;
+    vector<uint16_t> block_radar;
+    vector<size_t> block_records;
+
+    atomic<uint64_t> sent_plots;
+    atomic<uint64_t> sent_datagrams;
+    atomic<uint64_t> dropped_plots;
+};
+
+#endif
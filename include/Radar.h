@@ -1,9 +1,13 @@
 #ifndef RADAR_H
 #define RADAR_H
 
+#include "BeamGeometry.h"
 #include "Body.h"
+#include "FrameArena.h"
+#include "Span.h"
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <random>
 
@@ -22,6 +26,8 @@ struct Detection
 
 class Radar
 {
+    friend class Checkpoint;
+
 private:
     vector<float> pos;
     float max_range;
@@ -34,6 +40,11 @@ private:
     float velocity_noise_std;
     float detection_prob;
 
+    // Beam sweep of the last update step
+    float sweep_start;
+    float sweep_deg;
+    float step_dt;
+
     vector<Detection> detections;
 
     // Randomness helpers
@@ -42,30 +53,69 @@ private:
     uniform_real_distribution<float> uniform_dist;
 
     // Decides if the target is detected, considering detection probability and distance
-    bool shouldDetect(float distance, float azimuth);
+    bool shouldDetect(float distance);
 
 public:
     Radar(vector<float> pos, float max_range, float scan_interval = 0.25f, float beam_width = 10.0f, float noise_std = 2.0f);
 
     void update(float dt);
     void reset();
+    // Restarts the noise and detection draws from seed, e.g. to make forks of a
+    // restored checkpoint diverge
+    void reseed(unsigned seed);
 
     
     Detection scan(const Body &target, int target_id, float current_time);
-    bool checkDetection(Detection detection, float azimuth_threshold = 1.5f, float distance_threshold = 2.5f);
-    vector<Detection> scan(const vector<Body> &targets, float current_time);
+    bool checkDetection(const Detection &detection, float azimuth_threshold = BeamGeometry::DUPLICATE_AZIMUTH,
+                        float distance_threshold = BeamGeometry::DUPLICATE_DISTANCE);
+    // Scans all targets, records new detections and returns this step's new
+    // detections as a view into arena memory (valid until the arena is reset)
+    Span<const Detection> scan(const vector<Body> &targets, float current_time, FrameArena &arena);
+    // Same, but only evaluates the listed targets (ascending indices into targets)
+    Span<const Detection> scan(const vector<Body> &targets, Span<const uint32_t> indices, float current_time, FrameArena &arena);
+
+    // Records externally produced detections (e.g. from the signal-level model)
+    // and returns the ones that were new
+    Span<const Detection> record(Span<const Detection> candidates, FrameArena &arena);
+
+    // Tests the whole angular interval swept during the last step, including the
+    // wrap at 360, and reports how long before the end of the step the beam center
+    // crossed the target
+    bool findBeamCrossing(const Body &target, float &time_before_end) const;
+
+    // Time until the leading edge of the beam reaches the target, assuming the
+    // target keeps its current velocity. 0 if it is in the beam now or moving
+    // too fast in bearing to predict, negative if the beam does not rotate
+    float timeToBeamEntry(const Body &target) const;
 
     // Calculation functions
     float calculateDistance(const Body &target) const;
     float calculateAzimuth(const Body &target) const;
     float calculateVelocity(const Body &target) const;
+    float distanceTo(float x, float y) const;
+    float azimuthTo(float x, float y) const;
+    float radialVelocity(float x, float y, float vx, float vy) const;
 
     vector<float> get_pos() const { return pos; }
     float get_max_range() const { return max_range; }
     float getScanInterval() const { return scan_interval; }
     float getScanAngle() const { return scan_angle; }
     float getBeamWidth() const { return beam_width; }
-    vector<Detection> getDetections() { return detections; }
+    float getStepDt() const { return step_dt; }
+    float getSweepDeg() const { return sweep_deg; }
+    const vector<Detection> &getDetections() const { return detections; }
+    // Standard deviations of the measurement errors, the configured values scale norm_dist
+    float getDistanceNoise() const { return distance_noise_std * norm_dist.stddev(); }
+    float getAzimuthNoise() const { return azimuth_noise_std * norm_dist.stddev(); }
+    float getVelocityNoise() const { return velocity_noise_std * norm_dist.stddev(); }
+
+    void setDetectionProb(float prob) { detection_prob = prob; }
+    void setNoise(float distance_std, float azimuth_std, float velocity_std)
+    {
+        distance_noise_std = distance_std;
+        azimuth_noise_std = azimuth_std;
+        velocity_noise_std = velocity_std;
+    }
 };
 
 #endif
\ No newline at end of file
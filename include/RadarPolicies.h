@@ -0,0 +1,113 @@
+#ifndef RADAR_POLICIES_H
+#define RADAR_POLICIES_H
+
+#include "BeamGeometry.h"
+#include "Body.h"
+#include "Radar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace std;
+
+// Policies for BasicRadar. Each one is a small value type whose members are
+// called from the scan loop, so the compiler sees through all of them.
+//
+//   Detection model: bool detect(float range, Rng &rng)
+//   Noise model:     void apply(Detection &det, Rng &rng)
+//   Beam shape:      void update(float dt)
+//                    bool crossing(float az0, float az1, float &time_before_end) const
+//                    float center() const
+//
+// az0 and az1 are the target's bearings at the start and end of the step.
+namespace RadarPolicy
+{
+    // Every target in the beam and in range is detected, no random draw
+    struct AlwaysDetect
+    {
+        template <typename Rng>
+        bool detect(float, Rng &) { return true; }
+    };
+
+    // Constant probability of detection, one uniform draw per look
+    struct FixedPd
+    {
+        float pd = 0.95f;
+
+        template <typename Rng>
+        bool detect(float, Rng &rng) { return uniform_real_distribution<float>(0.0f, 1.0f)(rng) < pd; }
+    };
+
+    // Measurements are the true values
+    struct NoNoise
+    {
+        template <typename Rng>
+        void apply(Detection &, Rng &) {}
+    };
+
+    // Independent zero-mean Gaussian errors, standard deviations in m, deg, m/s
+    struct GaussianNoise
+    {
+        float range_std = 1.0f;
+        float azimuth_std = 0.25f;
+        float velocity_std = 0.25f;
+
+        template <typename Rng>
+        void apply(Detection &det, Rng &rng)
+        {
+            normal_distribution<float> unit(0.0f, 1.0f);
+            det.distance = max(det.distance + unit(rng) * range_std, 0.0f);
+            det.azimuth += unit(rng) * azimuth_std;
+            det.radial_velocity += unit(rng) * velocity_std;
+        }
+    };
+
+    // Fan beam rotating at a constant rate. The whole angle swept during a step is
+    // tested, with the same crossing rule as Radar::findBeamCrossing
+    struct SweptBeam
+    {
+        float width = 10.0f;
+        float revolutions_per_second = 0.25f;
+
+        float angle = 0.0f;
+        float sweep_start = 0.0f;
+        float sweep_deg = 0.0f;
+        float step_dt = 0.0f;
+
+        void update(float dt)
+        {
+            sweep_start = angle;
+            sweep_deg = 360.0f * revolutions_per_second * dt;
+            step_dt = dt;
+            angle = fmod(angle + sweep_deg, 360.0f);
+        }
+
+        bool crossing(float az0, float az1, float &time_before_end) const
+        {
+            return BeamGeometry::sweepCrossing(az0, az1, sweep_start, sweep_deg, angle, width / 2, step_dt,
+                                               time_before_end);
+        }
+
+        float center() const { return angle; }
+    };
+
+    // Fixed sector, looked at once per step. A width of 360 is an omnidirectional sensor
+    struct StaringBeam
+    {
+        float azimuth = 0.0f;
+        float width = 90.0f;
+
+        void update(float) {}
+
+        bool crossing(float, float az1, float &time_before_end) const
+        {
+            time_before_end = 0;
+            return width >= 360.0f || fabs(BeamGeometry::wrap180(az1 - azimuth)) <= width / 2;
+        }
+
+        float center() const { return azimuth; }
+    };
+}
+
+#endif
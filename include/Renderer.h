@@ -3,6 +3,8 @@
 
 #include "Radar.h"
 #include "Body.h"
+#include "Phosphor.h"
+#include "TrailStore.h"
 #include "constraints.h"
 
 #include <vector>
@@ -27,7 +29,18 @@ public:
     void draw_grid();
     void draw_radar(const Radar &radar);
     void draw_body(const Body &body,
-                   Detection detected);
+                   const Detection &detected);
+    void draw_ppi();
+    void draw_trails();
+
+    // Queues a step's new detections to be burnt into the PPI layer on the next render
+    void add_returns(const Radar &radar, Span<const Detection> detections);
+
+    // Samples the target positions into the trails, call once per simulation step.
+    // A change in the number of targets starts new trails
+    void record_trails(const vector<Body> &targets);
+    void clear_trails();
+    void set_trail_config(size_t length, unsigned decimation);
 
     float get_screen_height();
     float get_screen_width();
@@ -37,10 +50,11 @@ public:
 
     void close();
     void reset();
+    // detections holds the latest detection of each target, indexed like targets
     void render(
-        const Radar &radar, 
-        vector<Body> &targets, 
-        vector<Detection> &detections);
+        const Radar &radar,
+        const vector<Body> &targets,
+        Span<const Detection> detections);
 
     void flipPause();
     void setMouseDragging(
@@ -53,6 +67,8 @@ public:
         const sf::Event *event = nullptr);
 
     float advanceSimTime();
+    float getSimTime() const { return sim_time; }
+    void setSimTime(float time) { sim_time = time; }
 
     bool isDragging;
     bool isPaused;
@@ -74,6 +90,27 @@ private:
 
     sf::Vector2i currentMousePosition;
     sf::Vector2i previousMousePosition;
+
+    // Phosphor PPI layer. Returns accumulate in an off-screen texture that fades
+    // with one global decay pass per frame, so drawing cost follows new
+    // detections only, not the history still on screen
+    sf::RenderTexture ppi;
+    sf::VertexArray ppi_splats;
+    bool ppi_enabled;
+    Phosphor::Decay ppi_decay;
+    // (Re)creates the layer at the window size, returns whether it is usable
+    bool create_ppi(unsigned width, unsigned height);
+
+    // Target trails in one line list. Segment slots mirror the TrailStore ring
+    // (slot-major, segment s ends at sample s), so each new sample rewrites one
+    // contiguous row of vertices and blanks the row that would join the newest
+    // sample to the oldest. Nothing is allocated unless the target count changes
+    void write_trail_row(size_t slot, bool visible);
+
+    TrailStore trails;
+    vector<sf::Vertex> trail_vertices;
+    sf::VertexBuffer trail_buffer;
+    bool trail_buffer_enabled;
 };
 
 #endif
\ No newline at end of file
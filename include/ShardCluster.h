@@ -0,0 +1,137 @@
+#ifndef SHARD_CLUSTER_H
+#define SHARD_CLUSTER_H
+
+#include "Body.h"
+#include "Radar.h"
+#include "FrameArena.h"
+#include "Span.h"
+
+#include <cstdint>
+#include <vector>
+#include <sys/types.h>
+
+using namespace std;
+
+// Regular grid partition of the world. Shards on the border extend to infinity,
+// so every position has exactly one owner
+struct ShardGrid
+{
+    float min_x = -1000.0f, min_y = -1000.0f;
+    float max_x = 1000.0f, max_y = 1000.0f;
+    unsigned cols = 2, rows = 2;
+
+    size_t count() const { return (size_t)cols * rows; }
+    size_t shardOf(float x, float y) const;
+    // True if the circle overlaps the shard's region
+    bool intersects(size_t shard, float cx, float cy, float radius) const;
+};
+
+// Detection of one radar, as merged across radars in timestamp order
+struct ClusterDetection
+{
+    uint32_t radar;
+    Detection detection;
+};
+
+// Runs a scenario with its targets spread over worker processes, one per shard
+// of a ShardGrid. The coordinator (the calling process) owns the radars, their
+// noise and detection history; workers own the targets of their region and
+// talk to it over a Unix stream socket each.
+//
+// A step is two round trips:
+//   STEP  every worker moves its targets and hands back the ones that left its
+//         region, which the coordinator forwards to their new owner.
+//   SCAN  each radar is sent only to the shards its max_range circle touches.
+//         Workers mirror the radars' beams and return the targets the beam
+//         swept over, which the coordinator measures and records.
+// Workers answer in order on their own socket, so there is no locking. Replies
+// are read straight into the frame arena.
+class ShardCluster
+{
+public:
+    explicit ShardCluster(float dt = 0.016f, const ShardGrid &grid = ShardGrid());
+    // Shuts the workers down
+    ~ShardCluster();
+
+    ShardCluster(const ShardCluster &) = delete;
+    ShardCluster &operator=(const ShardCluster &) = delete;
+
+    // Returned by addRadar and addTargets when nothing was added
+    static const size_t INVALID_ID = (size_t)-1;
+
+    // Forks one worker per shard, returns false if a worker could not be started.
+    // Must be called before adding radars or targets, and before the caller starts
+    // threads. Starting again after a stop begins an empty scenario
+    bool start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    // The radar's beam restarts at 0 so the workers' copies stay in step with it.
+    // Both return INVALID_ID if the cluster is not running or a worker failed,
+    // which stops the cluster
+    size_t addRadar(const Radar &radar);
+    // Returns the id of the first target, ids are consecutive in insertion order
+    size_t addTarget(const Body &target);
+    size_t addTargets(const vector<Body> &targets);
+
+    // Returns false if a worker failed, the cluster is stopped then
+    bool step();
+    bool step(unsigned steps);
+
+    // New detections of the last step, valid until the next step
+    Span<const Detection> getStepDetections(size_t radar) const { return step_detections[radar]; }
+    // The same detections of every radar, ordered by timestamp
+    Span<const ClusterDetection> getMergedDetections() const { return merged; }
+
+    // Collects every target from the workers, indexed by id. Meant for checks, not per step
+    bool gather(vector<Body> &targets);
+
+    float getDt() const { return dt; }
+    float getSimTime() const { return sim_time; }
+    const ShardGrid &getGrid() const { return grid; }
+    const vector<Radar> &getRadars() const { return radars; }
+    size_t getTargetCount() const { return target_count; }
+    size_t getShardTargetCount(size_t shard) const { return shard_targets[shard]; }
+    // Targets handed from one shard to another so far
+    uint64_t getMigrations() const { return migrations; }
+    // Scan requests sent to workers so far, at most one per worker and step
+    uint64_t getScanRequests() const { return scan_requests; }
+
+private:
+    struct Worker
+    {
+        pid_t pid;
+        int fd;
+    };
+
+    // Worker side, never returns to the caller
+    [[noreturn]] static void serve(int fd, size_t shard, const ShardGrid &grid);
+
+    // STEP round trip, forwards targets that changed shard to their new owners
+    bool advance();
+    // SCAN round trip, measures and records what the beams swept over
+    bool scan();
+    // Reports the broken worker and stops the cluster, returns false
+    bool fail(size_t shard);
+
+    ShardGrid grid;
+    vector<Worker> workers;
+    bool running;
+
+    vector<Radar> radars;
+    size_t target_count;
+    vector<size_t> shard_targets;
+
+    // Messages, replies and results of a step all live here
+    FrameArena arena;
+    vector<Span<const Detection>> step_detections;
+    Span<const ClusterDetection> merged;
+
+    uint64_t migrations;
+    uint64_t scan_requests;
+
+    float dt;
+    float sim_time;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef SIGNAL_PROCESSOR_H
+#define SIGNAL_PROCESSOR_H
+
+#include "Body.h"
+#include "Radar.h"
+#include "FrameArena.h"
+#include "Span.h"
+
+#include <random>
+#include <vector>
+
+using namespace std;
+
+enum class CfarType
+{
+    CELL_AVERAGING,
+    ORDERED_STATISTIC
+};
+
+struct WaveformParams
+{
+    float carrier_freq = 10e9f;    // Hz
+    float sample_rate = 150e6f;    // Hz, complex baseband, one sample per range bin (1 m)
+    float prf = 10e3f;             // Hz
+    unsigned num_pulses = 64;      // per dwell, power of two
+    unsigned num_range_bins = 256; // fast-time samples per pulse
+    float snr_db = 10.0f;          // per-pulse, per-sample SNR at reference_range
+    float reference_range = 100.0f;
+
+    CfarType cfar = CfarType::CELL_AVERAGING;
+    unsigned cfar_guard = 2; // guard cells on each side
+    unsigned cfar_train = 8; // training cells on each side
+    float pfa = 1e-6f;
+};
+
+// Point target as seen by one dwell
+struct Echo
+{
+    float range;
+    float radial_velocity;
+    int target_id;
+};
+
+// Signal-level dwell model: synthesizes baseband IQ pulse trains for the
+// targets in the beam and runs matched filter -> range-Doppler FFT -> CFAR.
+//
+// The data cube is stored pulse-major as separate real and imaginary planes,
+// so the matched filter, the Doppler FFT butterflies and the power detector all
+// run as long contiguous loops over range bins that the compiler vectorizes.
+// Twiddles, bit reversal, window and CFAR scale are planned once, and every
+// buffer is reused between dwells.
+class SignalProcessor
+{
+    friend class Checkpoint;
+
+public:
+    // num_pulses is rounded up to a power of two, cfar_train to at least 1 and
+    // num_range_bins up to the code length plus one CFAR window
+    explicit SignalProcessor(const WaveformParams &waveform = WaveformParams(), unsigned seed = random_device{}());
+
+    // One dwell of the radar for the targets its beam swept over in the last step.
+    // The detections are recorded in the radar; the new ones are returned
+    Span<const Detection> scan(Radar &radar, const vector<Body> &targets, float current_time, FrameArena &arena);
+    // Restarts the receiver noise from seed
+    void reseed(unsigned seed);
+
+    // Synthesizes and processes one dwell. Detections are at the beam azimuth and
+    // are associated with the nearest echo within 1.5 resolution cells, else target_id -1
+    Span<const Detection> dwell(Span<const Echo> echoes, float azimuth, float timestamp, FrameArena &arena);
+
+    float getRangeResolution() const { return range_resolution; }
+    float getVelocityResolution() const { return velocity_resolution; }
+    float getMaxRange() const { return range_resolution * (params.num_range_bins - code.size()); }
+    // |range-Doppler|^2 of the last dwell, [doppler bin][range bin], zero Doppler at row 0
+    const vector<float> &getPowerMap() const { return power; }
+
+private:
+    void synthesize(Span<const Echo> echoes);
+    void matchedFilter();
+    void dopplerFft();
+    size_t cfar(Span<Detection> out, Span<const Echo> echoes, float azimuth, float timestamp);
+
+    float cfarThreshold(const float *row, size_t n);
+    float velocityOfBin(float bin) const;
+
+    WaveformParams params;
+    float range_resolution;
+    float velocity_resolution;
+    float wavelength;
+
+    // Plan
+    vector<float> code;          // Barker-13 phase code, one chip per sample
+    vector<float> window;        // slow-time Hann window, folded into the matched filter
+    vector<float> twiddle_re;    // e^{-2 pi i k / N}, k < N/2
+    vector<float> twiddle_im;
+    vector<unsigned> bit_reverse;
+    float cfar_alpha;
+    size_t os_rank;
+
+    // Reused buffers, num_pulses x num_range_bins
+    vector<float> rx_re, rx_im;
+    vector<float> rd_re, rd_im;
+    vector<float> power;
+    vector<float> scratch;
+
+    default_random_engine generator;
+    normal_distribution<float> noise;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Body.h"
+#include "Radar.h"
+#include "Checkpoint.h"
+#include "BeamScheduler.h"
+#include "SignalProcessor.h"
+#include "FrameArena.h"
+#include "Span.h"
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Headless scenario: owns the targets and radars and advances them in lockstep.
+// This is what the library and its C API drive, independent of the renderer.
+class Simulation
+{
+public:
+    Simulation(float dt = 0.016f);
+
+    size_t addRadar(const Radar &radar);
+    size_t addTarget(const Body &target);
+
+    void step();
+    void step(unsigned steps);
+
+    void setScanMode(ScanMode mode);
+    ScanMode getScanMode() const { return scan_mode; }
+    // Changes a target's acceleration, so event-driven predictions get refreshed
+    void manoeuvre(size_t target, const vector<float> &accel);
+    const BeamScheduler &getScheduler() const { return scheduler; }
+
+    // Switches a radar to the signal-level model: its detections come from a
+    // synthesized IQ dwell and the range-Doppler/CFAR chain instead of geometry
+    void enableSignalModel(size_t radar, const WaveformParams &params, unsigned seed = random_device{}());
+    void disableSignalModel(size_t radar);
+
+    Checkpoint checkpoint() const;
+    // Continues exactly where the checkpoint was taken, signal models included
+    bool restore(const Checkpoint &checkpoint);
+    // Same state, but the radars and signal models draw noise from new seeds
+    // derived from seed, so forks restored with different seeds diverge
+    bool restore(const Checkpoint &checkpoint, unsigned seed);
+
+    float getDt() const { return dt; }
+    float getSimTime() const { return sim_time; }
+    const vector<Radar> &getRadars() const { return radars; }
+    const vector<Body> &getTargets() const { return targets; }
+    vector<Radar> &getRadars() { return radars; }
+    vector<Body> &getTargets() { return targets; }
+    // New detections of the last step, valid until the next step
+    Span<const Detection> getStepDetections(size_t radar) const { return step_detections[radar]; }
+
+private:
+    vector<Radar> radars;
+    vector<Body> targets;
+
+    // Transient per-step results, reset at the start of every step
+    FrameArena arena;
+    vector<Span<const Detection>> step_detections;
+
+    ScanMode scan_mode;
+    BeamScheduler scheduler;
+    vector<unique_ptr<SignalProcessor>> signal_models; // per radar, null for geometric detection
+
+    float dt;
+    float sim_time;
+};
+
+#endif
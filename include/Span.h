@@ -0,0 +1,32 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <cstddef>
+
+// Non-owning view over a contiguous run of T, a minimal stand-in for C++20 std::span.
+// The viewed storage must outlive the span.
+template <typename T>
+class Span
+{
+public:
+    Span() : ptr(nullptr), len(0) {}
+    Span(T *data, size_t size) : ptr(data), len(size) {}
+
+    // Views any contiguous container with data() and size(), e.g. a vector
+    template <typename Container>
+    Span(Container &container) : ptr(container.data()), len(container.size()) {}
+
+    T *data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+
+    T &operator[](size_t i) const { return ptr[i]; }
+    T *begin() const { return ptr; }
+    T *end() const { return ptr + len; }
+
+private:
+    T *ptr;
+    size_t len;
+};
+
+#endif
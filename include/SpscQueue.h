@@ -0,0 +1,67 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Storage is allocated once up front, push and pop never allocate.
+template <typename T>
+class SpscQueue
+{
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity)
+        : head(0),
+          tail(0)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // Producer side, returns false if the queue is full
+    bool push(const T &value)
+    {
+        size_t t = tail.load(memory_order_relaxed);
+        if (t - head.load(memory_order_acquire) > mask)
+            return false;
+        slots[t & mask] = value;
+        tail.store(t + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer side, pops up to max_count items into out and returns how many were taken
+    size_t pop(T *out, size_t max_count)
+    {
+        size_t h = head.load(memory_order_relaxed);
+        size_t available = tail.load(memory_order_acquire) - h;
+        size_t n = available < max_count ? available : max_count;
+        for (size_t i = 0; i < n; i++)
+            out[i] = slots[(h + i) & mask];
+        head.store(h + n, memory_order_release);
+        return n;
+    }
+
+    bool empty() const
+    {
+        return head.load(memory_order_acquire) == tail.load(memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    vector<T> slots;
+    size_t mask;
+
+    // Kept on separate cache lines so producer and consumer don't false-share
+    alignas(64) atomic<size_t> head;
+    alignas(64) atomic<size_t> tail;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef TRAIL_STORE_H
+#define TRAIL_STORE_H
+
+#include "Body.h"
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Recent position history of every target in one shared ring buffer.
+// All targets are sampled together, so they share the write head. Positions are
+// kept as separate x and y planes laid out slot-major ([slot * targets + target]),
+// which makes the samples written in one call a single contiguous run.
+class TrailStore
+{
+public:
+    TrailStore(size_t length = 64, unsigned decimation = 4);
+
+    // length samples per trail, one sample every decimation calls to record()
+    void configure(size_t length, unsigned decimation);
+    // Drops every trail, the next reset() starts over
+    void clear();
+
+    // Starts new trails, every slot holds the current position so no stray segments show
+    void reset(const vector<Body> &targets);
+    // Samples the targets every decimation-th call, returns true if a sample was written.
+    // targets must have the size given to reset()
+    bool record(const vector<Body> &targets);
+
+    size_t getTargetCount() const { return target_count; }
+    size_t getLength() const { return length; }
+    unsigned getDecimation() const { return decimation; }
+    // Slot of the newest sample, the oldest is the one after it
+    size_t getHead() const { return head; }
+
+    float x(size_t slot, size_t target) const { return xs[slot * target_count + target]; }
+    float y(size_t slot, size_t target) const { return ys[slot * target_count + target]; }
+
+private:
+    size_t length;
+    unsigned decimation;
+    unsigned calls;
+
+    size_t target_count;
+    size_t head;
+    vector<float> xs;
+    vector<float> ys;
+};
+
+#endif
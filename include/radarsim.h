@@ -0,0 +1,67 @@
+#ifndef RADARSIM_H
+#define RADARSIM_H
+
+/*
+ * C API for libradarsim.
+ *
+ * Views returned by rs_targets / rs_detections point straight into the
+ * simulation's own storage, nothing is copied. Field i of element n lives at
+ * (const char *)field + n * stride. A view stays valid until the next call
+ * that mutates the scenario (rs_step, rs_add_*, rs_scenario_destroy).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct rs_scenario rs_scenario;
+
+    typedef struct
+    {
+        const float *pos;   /* x, y */
+        const float *vel;   /* vx, vy */
+        const float *accel; /* ax, ay */
+        size_t count;
+        size_t stride; /* bytes between consecutive targets */
+    } rs_target_view;
+
+    typedef struct
+    {
+        const bool *detected; /* true if produced by the latest scan */
+        const float *distance;
+        const float *azimuth;
+        const float *radial_velocity;
+        const float *timestamp;
+        const int *target_id;
+        size_t count;
+        size_t stride; /* bytes between consecutive detections */
+    } rs_detection_view;
+
+    rs_scenario *rs_scenario_create(float dt);
+    void rs_scenario_destroy(rs_scenario *scenario);
+
+    /* Return the index of the new radar / target, or -1 on failure */
+    int rs_add_radar(rs_scenario *scenario, float x, float y, float max_range,
+                     float scan_interval, float beam_width, float noise_std);
+    int rs_add_target(rs_scenario *scenario, float x, float y,
+                      float vx, float vy, float ax, float ay);
+
+    void rs_step(rs_scenario *scenario, unsigned steps);
+
+    float rs_sim_time(const rs_scenario *scenario);
+    size_t rs_radar_count(const rs_scenario *scenario);
+    float rs_scan_angle(const rs_scenario *scenario, size_t radar);
+
+    rs_target_view rs_targets(const rs_scenario *scenario);
+    /* Returns 0 on success, -1 if the radar index is out of range */
+    int rs_detections(const rs_scenario *scenario, size_t radar, rs_detection_view *view);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,7 @@
+#include "BasicRadar.h"
+
+// The common configurations are compiled once here, users of the header link
+// against these instead of instantiating the scan loop in every translation unit
+template class BasicRadar<RadarPolicy::AlwaysDetect, RadarPolicy::NoNoise, RadarPolicy::SweptBeam>;
+template class BasicRadar<RadarPolicy::FixedPd, RadarPolicy::GaussianNoise, RadarPolicy::SweptBeam>;
+template class BasicRadar<RadarPolicy::FixedPd, RadarPolicy::GaussianNoise, RadarPolicy::StaringBeam>;
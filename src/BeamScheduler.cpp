@@ -0,0 +1,132 @@
+#include "BeamScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+    // Events at this time are due on the very next step
+    const float DUE_NOW = -numeric_limits<float>::infinity();
+}
+
+BeamScheduler::BeamScheduler()
+    : known_targets(0),
+      evaluations(0)
+{
+}
+
+void BeamScheduler::clear()
+{
+    queues.clear();
+    generations.clear();
+    known_targets = 0;
+}
+
+void BeamScheduler::invalidate(size_t target)
+{
+    if (target >= known_targets)
+        return;
+
+    // Outstanding events of this target become stale and are skipped when popped
+    generations[target]++;
+    for (size_t r = 0; r < queues.size(); r++)
+        schedule(r, target, DUE_NOW);
+}
+
+void BeamScheduler::schedule(size_t radar_index, uint32_t target, float time)
+{
+    vector<Event> &queue = queues[radar_index];
+    queue.push_back({time, target, generations[target]});
+    push_heap(queue.begin(), queue.end());
+}
+
+void BeamScheduler::sync(size_t radar_count, size_t target_count)
+{
+    // Targets were removed or replaced, start over
+    if (target_count < known_targets)
+        clear();
+
+    // A new radar starts with every known target due
+    while (queues.size() < radar_count)
+    {
+        queues.emplace_back();
+        for (uint32_t t = 0; t < known_targets; t++)
+            schedule(queues.size() - 1, t, DUE_NOW);
+    }
+
+    // New targets are due on every radar
+    if (target_count > known_targets)
+    {
+        generations.resize(target_count, 0);
+        for (size_t r = 0; r < queues.size(); r++)
+            for (size_t t = known_targets; t < target_count; t++)
+                schedule(r, t, DUE_NOW);
+        known_targets = target_count;
+    }
+}
+
+Span<const Detection> BeamScheduler::scan(size_t radar_index, Radar &radar, const vector<Body> &targets,
+                                          float current_time, FrameArena &arena)
+{
+    sync(radar_index + 1, targets.size());
+    vector<Event> &queue = queues[radar_index];
+
+    due.clear();
+    while (!queue.empty() && queue.front().time <= current_time)
+    {
+        pop_heap(queue.begin(), queue.end());
+        Event event = queue.back();
+        queue.pop_back();
+        if (event.generation == generations[event.target])
+            due.push_back(event.target);
+    }
+
+    // Evaluate in index order, like a full scan does
+    sort(due.begin(), due.end());
+    evaluations += due.size();
+    Span<const Detection> detections = radar.scan(targets, Span<const uint32_t>(due), current_time, arena);
+
+    float step_dt = radar.getStepDt();
+    float revolution = radar.getScanInterval() > 0 ? 1.0f / radar.getScanInterval() : 1.0f;
+    float beam_rate = 2.0f * M_PI * radar.getScanInterval(); // rad/s
+    for (uint32_t t : due)
+    {
+        const Body &target = targets[t];
+        float wait = radar.timeToBeamEntry(target);
+        if (wait < 0)
+            wait = revolution; // beam is not rotating, check again later
+        else if (wait <= step_dt)
+            wait = 0; // beam reaches it during the next step's sweep
+        else
+        {
+            wait *= REFINE_FACTOR;
+
+            // Bound how far the bearing can drift from the linear prediction. Within
+            // the wait the target covers at most half its range, so it stays beyond
+            // r / 2, its speed stays below v + |a| t, and its bearing accelerates by
+            // at most (|a| + 2 v^2 / r) / r. The drift has to stay inside the part of
+            // the beam travel the refine factor holds back, so we never wake up late
+            const float *vel = target.vel_data();
+            const float *accel = target.accel_data();
+            float speed = sqrt(vel[0] * vel[0] + vel[1] * vel[1]);
+            float accel_norm = sqrt(accel[0] * accel[0] + accel[1] * accel[1]);
+            float near = radar.calculateDistance(target) / 2;
+            if (accel_norm > 0)
+                wait = min(wait, (sqrt(speed * speed + 2 * accel_norm * near) - speed) / accel_norm);
+            else if (speed > 0)
+                wait = min(wait, near / speed);
+
+            float max_speed = speed + accel_norm * wait;
+            float bearing_accel = near > 0 ? (accel_norm + 2 * max_speed * max_speed / near) / near : 0.0f; // rad/s^2
+            float slack_rate = (1 - REFINE_FACTOR) / REFINE_FACTOR * beam_rate / 2; // closing rate >= beam rate / 2
+            if (bearing_accel > 0)
+                wait = min(wait, 2 * slack_rate / bearing_accel);
+        }
+        schedule(radar_index, t, current_time + wait);
+    }
+
+    return detections;
+}
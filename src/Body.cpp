@@ -3,23 +3,32 @@
 #include <ostream>
 
 Body::Body(std::vector<float> pos, std::vector<float> vel, std::vector<float> accel) {
-    this->pos = pos;
-    this->vel = vel;
-    this->accel = accel;
+    this->pos = to_array(pos);
+    this->vel = to_array(vel);
+    this->accel = to_array(accel);
 }
 
 Body::Body(std::vector<float> pos, std::vector<float> vel) {
-    this->pos = pos;
-    this->vel = vel;
+    this->pos = to_array(pos);
+    this->vel = to_array(vel);
     this->accel = {0, 0};
 }
 
 Body::Body(std::vector<float> pos) {
-    this->pos = pos;
+    this->pos = to_array(pos);
     this->vel = {0, 0};
     this->accel = {0, 0};
 }
 
+// Bodies are 2D, missing components default to 0
+std::array<float, 2> Body::to_array(const std::vector<float> &values)
+{
+    std::array<float, 2> out = {0, 0};
+    for (size_t i = 0; i < out.size() && i < values.size(); i++)
+        out[i] = values[i];
+    return out;
+}
+
 
 void Body::update(float dt)
 {
@@ -32,12 +41,12 @@ void Body::update(float dt)
 
 void Body::update(float dt, std::vector<float> accel)
 {
-    this->accel = accel;
+    this->accel = to_array(accel);
     Body::update(dt);
 }
 
 std::ostream& operator<<(std::ostream& os, const Body& body)
 {
-    os << "(" << body.get_pos()[0] << ", " << body.get_pos()[1] <<")";
+    os << "(" << body.pos[0] << ", " << body.pos[1] <<")";
     return os;
 }
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "Checkpoint.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace std;
+
+namespace
+{
+    const char MAGIC[4] = {'R', 'S', 'C', 'K'};
+    const uint32_t VERSION = 3;
+
+    class Writer
+    {
+    public:
+        explicit Writer(vector<char> &out) : out(out) {}
+
+        void bytes(const void *src, size_t n)
+        {
+            const char *p = static_cast<const char *>(src);
+            out.insert(out.end(), p, p + n);
+        }
+
+        template <typename T>
+        void put(const T &value) { bytes(&value, sizeof(T)); }
+
+        void floats(const vector<float> &values)
+        {
+            put<uint32_t>(values.size());
+            bytes(values.data(), values.size() * sizeof(float));
+        }
+
+        // Standard engines and distributions only expose their state as text
+        template <typename T>
+        void stream_state(const T &value)
+        {
+            stringstream ss;
+            ss << value;
+            string s = ss.str();
+            put<uint32_t>(s.size());
+            bytes(s.data(), s.size());
+        }
+
+    private:
+        vector<char> &out;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const vector<char> &in) : in(in), offset(0), ok(true) {}
+
+        bool bytes(void *dst, size_t n)
+        {
+            if (!ok || in.size() - offset < n)
+                return ok = false;
+            if (n == 0)
+                return true;
+            memcpy(dst, in.data() + offset, n);
+            offset += n;
+            return true;
+        }
+
+        template <typename T>
+        T get()
+        {
+            T value{};
+            bytes(&value, sizeof(T));
+            return value;
+        }
+
+        // Checks that count items of item_size bytes remain before anything is
+        // allocated for them, so a corrupt count fails instead of exhausting memory
+        bool fits(size_t count, size_t item_size)
+        {
+            if (!ok || (in.size() - offset) / item_size < count)
+                return ok = false;
+            return true;
+        }
+
+        vector<float> floats()
+        {
+            uint32_t n = get<uint32_t>();
+            if (!fits(n, sizeof(float)))
+                return {};
+            vector<float> values(n);
+            bytes(values.data(), n * sizeof(float));
+            return values;
+        }
+
+        template <typename T>
+        void stream_state(T &value)
+        {
+            uint32_t n = get<uint32_t>();
+            if (!ok || in.size() - offset < n)
+            {
+                ok = false;
+                return;
+            }
+            stringstream ss(string(in.data() + offset, n));
+            offset += n;
+            ss >> value;
+            if (ss.fail())
+                ok = false;
+        }
+
+        bool good() const { return ok; }
+
+    private:
+        const vector<char> &in;
+        size_t offset;
+        bool ok;
+    };
+}
+
+Checkpoint::Checkpoint() {}
+
+Checkpoint::Checkpoint(shared_ptr<const vector<char>> data) : data(move(data)) {}
+
+Checkpoint Checkpoint::capture(const vector<Radar> &radars, const vector<Body> &targets, float sim_time)
+{
+    return capture(radars, targets, sim_time, vector<unique_ptr<SignalProcessor>>());
+}
+
+Checkpoint Checkpoint::capture(const vector<Radar> &radars, const vector<Body> &targets, float sim_time,
+                               const vector<unique_ptr<SignalProcessor>> &signal_models)
+{
+    auto buffer = make_shared<vector<char>>();
+    Writer w(*buffer);
+
+    w.bytes(MAGIC, sizeof(MAGIC));
+    w.put<uint32_t>(VERSION);
+    w.put<float>(sim_time);
+
+    w.put<uint32_t>(targets.size());
+    for (const auto &target : targets)
+    {
+        w.floats(target.get_pos());
+        w.floats(target.get_vel());
+        w.floats(target.get_accel());
+    }
+
+    w.put<uint32_t>(radars.size());
+    for (const auto &radar : radars)
+    {
+        w.floats(radar.pos);
+        w.put<float>(radar.max_range);
+        w.put<float>(radar.scan_interval);
+        w.put<float>(radar.scan_angle);
+        w.put<float>(radar.beam_width);
+        w.put<float>(radar.distance_noise_std);
+        w.put<float>(radar.azimuth_noise_std);
+        w.put<float>(radar.velocity_noise_std);
+        w.put<float>(radar.detection_prob);
+        w.put<float>(radar.sweep_start);
+        w.put<float>(radar.sweep_deg);
+        w.put<float>(radar.step_dt);
+
+        // Detection is plain data, so the live list goes out as one block
+        w.put<uint32_t>(radar.detections.size());
+        w.bytes(radar.detections.data(), radar.detections.size() * sizeof(Detection));
+
+        w.stream_state(radar.generator);
+        w.stream_state(radar.norm_dist);
+        w.stream_state(radar.uniform_dist);
+    }
+
+    // One flag per radar, followed by the model's waveform and noise state.
+    // The plan and buffers are rebuilt from the waveform
+    for (size_t i = 0; i < radars.size(); i++)
+    {
+        const SignalProcessor *model = i < signal_models.size() ? signal_models[i].get() : nullptr;
+        w.put<uint8_t>(model != nullptr);
+        if (!model)
+            continue;
+        w.put(model->params);
+        w.stream_state(model->generator);
+        w.stream_state(model->noise);
+    }
+
+    return Checkpoint(buffer);
+}
+
+bool Checkpoint::restore(vector<Radar> &radars, vector<Body> &targets, float &sim_time) const
+{
+    vector<Radar> new_radars;
+    vector<Body> new_targets;
+    vector<unique_ptr<SignalProcessor>> signal_models;
+    float time;
+    if (!restore(new_radars, new_targets, time, signal_models))
+        return false;
+    for (const auto &model : signal_models)
+        if (model)
+            return false;
+
+    radars = move(new_radars);
+    targets = move(new_targets);
+    sim_time = time;
+    return true;
+}
+
+bool Checkpoint::restore(vector<Radar> &radars, vector<Body> &targets, float &sim_time,
+                         vector<unique_ptr<SignalProcessor>> &signal_models) const
+{
+    if (empty())
+        return false;
+
+    Reader r(*data);
+
+    char magic[sizeof(MAGIC)];
+    r.bytes(magic, sizeof(magic));
+    if (!r.good() || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || r.get<uint32_t>() != VERSION)
+        return false;
+
+    float time = r.get<float>();
+
+    vector<Body> new_targets;
+    uint32_t target_count = r.get<uint32_t>();
+    for (uint32_t i = 0; i < target_count && r.good(); i++)
+    {
+        vector<float> pos = r.floats();
+        vector<float> vel = r.floats();
+        vector<float> accel = r.floats();
+        if (r.good())
+            new_targets.emplace_back(pos, vel, accel);
+    }
+
+    vector<Radar> new_radars;
+    uint32_t radar_count = r.get<uint32_t>();
+    for (uint32_t i = 0; i < radar_count && r.good(); i++)
+    {
+        vector<float> pos = r.floats();
+        float max_range = r.get<float>();
+        float scan_interval = r.get<float>();
+        float scan_angle = r.get<float>();
+        float beam_width = r.get<float>();
+        float distance_noise_std = r.get<float>();
+
+        Radar radar(pos, max_range, scan_interval, beam_width, distance_noise_std);
+        radar.scan_angle = scan_angle;
+        radar.azimuth_noise_std = r.get<float>();
+        radar.velocity_noise_std = r.get<float>();
+        radar.detection_prob = r.get<float>();
+        radar.sweep_start = r.get<float>();
+        radar.sweep_deg = r.get<float>();
+        radar.step_dt = r.get<float>();
+
+        uint32_t detection_count = r.get<uint32_t>();
+        if (!r.fits(detection_count, sizeof(Detection)))
+            break;
+        radar.detections.resize(detection_count);
+        r.bytes(radar.detections.data(), detection_count * sizeof(Detection));
+
+        r.stream_state(radar.generator);
+        r.stream_state(radar.norm_dist);
+        r.stream_state(radar.uniform_dist);
+
+        new_radars.push_back(move(radar));
+    }
+
+    vector<unique_ptr<SignalProcessor>> new_models(new_radars.size());
+    for (size_t i = 0; i < new_models.size() && r.good(); i++)
+    {
+        if (!r.get<uint8_t>())
+            continue;
+        WaveformParams params = r.get<WaveformParams>();
+        if (!r.good())
+            break;
+        // The stored waveform is already normalized, so the plan comes out the same
+        unique_ptr<SignalProcessor> model(new SignalProcessor(params, 0));
+        r.stream_state(model->generator);
+        r.stream_state(model->noise);
+        new_models[i] = move(model);
+    }
+
+    if (!r.good())
+        return false;
+
+    radars = move(new_radars);
+    signal_models = move(new_models);
+    targets = move(new_targets);
+    sim_time = time;
+    return true;
+}
+
+bool Checkpoint::save(const string &path) const
+{
+    if (empty())
+        return false;
+
+    // Write next to the destination and rename, so readers never see a partial file
+    string tmp_path = path + ".tmp";
+    {
+        ofstream out(tmp_path, ios::binary | ios::trunc);
+        if (!out)
+            return false;
+        out.write(data->data(), data->size());
+        if (!out)
+            return false;
+    }
+    return rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+future<bool> Checkpoint::saveAsync(const string &path) const
+{
+    // The lambda holds its own reference to the immutable buffer
+    Checkpoint snapshot(*this);
+    return async(launch::async, [snapshot, path]()
+                 { return snapshot.save(path); });
+}
+
+bool Checkpoint::load(const string &path, Checkpoint &checkpoint)
+{
+    ifstream in(path, ios::binary | ios::ate);
+    if (!in)
+        return false;
+
+    streamsize size = in.tellg();
+    if (size <= 0)
+        return false;
+    in.seekg(0, ios::beg);
+
+    auto buffer = make_shared<vector<char>>(size);
+    if (!in.read(buffer->data(), size))
+        return false;
+
+    checkpoint = Checkpoint(buffer);
+    return true;
+}
@@ -0,0 +1,314 @@
+#include "DetectionHistory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+HistoryResolution HistoryResolution::forRadar(const Radar &radar)
+{
+    HistoryResolution resolution;
+    if (radar.getDistanceNoise() > 0)
+        resolution.range = radar.getDistanceNoise() / 4;
+    if (radar.getAzimuthNoise() > 0)
+        resolution.azimuth = radar.getAzimuthNoise() / 4;
+    if (radar.getVelocityNoise() > 0)
+        resolution.velocity = radar.getVelocityNoise() / 4;
+    return resolution;
+}
+
+namespace
+{
+    float wrap360(float deg)
+    {
+        deg = fmod(deg, 360.0f);
+        if (deg < 0)
+            deg += 360.0f;
+        return deg;
+    }
+
+    uint8_t widthFor(uint64_t spread)
+    {
+        if (spread <= numeric_limits<uint8_t>::max())
+            return 1;
+        if (spread <= numeric_limits<uint16_t>::max())
+            return 2;
+        if (spread <= numeric_limits<uint32_t>::max())
+            return 4;
+        return 8;
+    }
+
+    template <typename T>
+    void pack(const int64_t *values, size_t count, int64_t base, uint8_t *dst)
+    {
+        T *__restrict out = reinterpret_cast<T *>(dst);
+        for (size_t i = 0; i < count; i++)
+            out[i] = (T)(values[i] - base);
+    }
+
+    // Widen, scale and add, no dependency between records
+    template <typename T>
+    void widen(const uint8_t *src, size_t count, float base, float scale, float *__restrict out)
+    {
+        const T *__restrict values = reinterpret_cast<const T *>(src);
+        for (size_t i = 0; i < count; i++)
+            out[i] = base + (float)values[i] * scale;
+    }
+
+    template <typename T>
+    void widenIds(const uint8_t *src, size_t count, int64_t base, int32_t *__restrict out)
+    {
+        const T *__restrict values = reinterpret_cast<const T *>(src);
+        for (size_t i = 0; i < count; i++)
+            out[i] = (int32_t)(base + (int64_t)values[i]);
+    }
+
+    // Segments start on 8 bytes so each one can be read as an array of its width
+    size_t align8(size_t offset) { return (offset + 7) & ~(size_t)7; }
+}
+
+size_t DetectionHistory::addRadar(const HistoryResolution &resolution)
+{
+    RadarHistory history;
+    history.resolution = resolution;
+    for (vector<int64_t> &field : history.open)
+        field.reserve(BLOCK_SIZE);
+    radars.push_back(move(history));
+    return radars.size() - 1;
+}
+
+void DetectionHistory::append(size_t radar, Span<const Detection> detections)
+{
+    if (detections.empty())
+        return;
+
+    RadarHistory &history = radars[radar];
+    const HistoryResolution &res = history.resolution;
+
+    sorted.assign(detections.begin(), detections.end());
+    stable_sort(sorted.begin(), sorted.end(),
+                [](const Detection &a, const Detection &b) { return a.timestamp < b.timestamp; });
+
+    for (const Detection &det : sorted)
+    {
+        if (history.open[TIME].empty())
+            history.open_t_min = det.timestamp;
+        history.open_t_max = det.timestamp;
+
+        history.open[TIME].push_back(llround(det.timestamp / res.time));
+        history.open[RANGE].push_back(llround(det.distance / res.range));
+        history.open[AZIMUTH].push_back(llround(wrap360(det.azimuth) / res.azimuth));
+        history.open[VELOCITY].push_back(llround(det.radial_velocity / res.velocity));
+        history.open[TARGET].push_back(det.target_id);
+
+        if (history.open[TIME].size() == BLOCK_SIZE)
+            seal(history);
+    }
+}
+
+void DetectionHistory::flush()
+{
+    for (RadarHistory &history : radars)
+        if (!history.open[TIME].empty())
+            seal(history);
+}
+
+void DetectionHistory::seal(RadarHistory &history)
+{
+    Block block;
+    block.count = history.open[TIME].size();
+    block.t_min = history.open_t_min;
+    block.t_max = history.open_t_max;
+    // Keep the block ends sorted for the binary search even if a batch steps back a little
+    if (!history.blocks.empty())
+        block.t_max = max(block.t_max, history.blocks.back().t_max);
+
+    size_t bytes = 0;
+    for (int f = 0; f < FIELD_COUNT; f++)
+    {
+        const vector<int64_t> &values = history.open[f];
+        auto range = minmax_element(values.begin(), values.end());
+        block.base[f] = *range.first;
+        block.width[f] = widthFor((uint64_t)(*range.second - *range.first));
+        bytes = align8(bytes) + block.width[f] * block.count;
+    }
+
+    if (history.pages.empty() || history.pages.back().size() + bytes + 8 > PAGE_SIZE)
+    {
+        history.pages.emplace_back();
+        history.pages.back().reserve(PAGE_SIZE);
+    }
+    vector<uint8_t> &page = history.pages.back();
+    block.page = history.pages.size() - 1;
+    block.offset = align8(page.size());
+
+    size_t offset = block.offset;
+    for (int f = 0; f < FIELD_COUNT; f++)
+    {
+        offset = align8(offset);
+        page.resize(offset + block.width[f] * block.count);
+        uint8_t *dst = page.data() + offset;
+        const int64_t *values = history.open[f].data();
+        switch (block.width[f])
+        {
+        case 1:
+            pack<uint8_t>(values, block.count, block.base[f], dst);
+            break;
+        case 2:
+            pack<uint16_t>(values, block.count, block.base[f], dst);
+            break;
+        case 4:
+            pack<uint32_t>(values, block.count, block.base[f], dst);
+            break;
+        default:
+            pack<uint64_t>(values, block.count, block.base[f], dst);
+        }
+        offset += block.width[f] * block.count;
+        history.open[f].clear();
+    }
+
+    history.blocks.push_back(block);
+    history.sealed_count += block.count;
+}
+
+void DetectionHistory::decode(const RadarHistory &history, const Block &block, Columns &columns)
+{
+    const HistoryResolution &res = history.resolution;
+    const float scales[TARGET] = {res.time, res.range, res.azimuth, res.velocity};
+    float *outputs[TARGET] = {columns.time, columns.range, columns.azimuth, columns.velocity};
+
+    const uint8_t *src = history.pages[block.page].data() + block.offset;
+    size_t offset = 0;
+    for (int f = 0; f < FIELD_COUNT; f++)
+    {
+        offset = align8(offset);
+        const uint8_t *segment = src + offset;
+        offset += block.width[f] * block.count;
+
+        if (f == TARGET)
+        {
+            switch (block.width[f])
+            {
+            case 1:
+                widenIds<uint8_t>(segment, block.count, block.base[f], columns.target);
+                break;
+            case 2:
+                widenIds<uint16_t>(segment, block.count, block.base[f], columns.target);
+                break;
+            case 4:
+                widenIds<uint32_t>(segment, block.count, block.base[f], columns.target);
+                break;
+            default:
+                widenIds<uint64_t>(segment, block.count, block.base[f], columns.target);
+            }
+            continue;
+        }
+
+        float base = (float)((double)block.base[f] * scales[f]);
+        switch (block.width[f])
+        {
+        case 1:
+            widen<uint8_t>(segment, block.count, base, scales[f], outputs[f]);
+            break;
+        case 2:
+            widen<uint16_t>(segment, block.count, base, scales[f], outputs[f]);
+            break;
+        case 4:
+            widen<uint32_t>(segment, block.count, base, scales[f], outputs[f]);
+            break;
+        default:
+            widen<uint64_t>(segment, block.count, base, scales[f], outputs[f]);
+        }
+    }
+}
+
+void DetectionHistory::decodeOpen(const RadarHistory &history, Columns &columns)
+{
+    const HistoryResolution &res = history.resolution;
+    size_t count = history.open[TIME].size();
+    for (size_t i = 0; i < count; i++)
+    {
+        columns.time[i] = (float)((double)history.open[TIME][i] * res.time);
+        columns.range[i] = (float)((double)history.open[RANGE][i] * res.range);
+        columns.azimuth[i] = (float)((double)history.open[AZIMUTH][i] * res.azimuth);
+        columns.velocity[i] = (float)((double)history.open[VELOCITY][i] * res.velocity);
+        columns.target[i] = (int32_t)history.open[TARGET][i];
+    }
+}
+
+size_t DetectionHistory::emit(const Columns &columns, size_t count, float t0, float t1, vector<Detection> &out)
+{
+    size_t emitted = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (columns.time[i] < t0 || columns.time[i] > t1)
+            continue;
+        Detection det;
+        det.detected = true;
+        det.distance = columns.range[i];
+        det.azimuth = columns.azimuth[i];
+        det.radial_velocity = columns.velocity[i];
+        det.timestamp = columns.time[i];
+        det.target_id = columns.target[i];
+        det.lifespan = 0;
+        out.push_back(det);
+        emitted++;
+    }
+    return emitted;
+}
+
+size_t DetectionHistory::query(size_t radar, float t0, float t1, vector<Detection> &out) const
+{
+    if (radar >= radars.size() || t1 < t0)
+        return 0;
+
+    const RadarHistory &history = radars[radar];
+    // Widen the window by a time step so rounding at the block ends can't drop records
+    float margin = history.resolution.time;
+    Columns columns;
+    size_t emitted = 0;
+
+    auto it = lower_bound(history.blocks.begin(), history.blocks.end(), t0 - margin,
+                          [](const Block &block, float t) { return block.t_max < t; });
+    for (; it != history.blocks.end() && it->t_min <= t1 + margin; ++it)
+    {
+        decode(history, *it, columns);
+        emitted += emit(columns, it->count, t0, t1, out);
+    }
+
+    if (!history.open[TIME].empty() && history.open_t_max >= t0 - margin && history.open_t_min <= t1 + margin)
+    {
+        decodeOpen(history, columns);
+        emitted += emit(columns, history.open[TIME].size(), t0, t1, out);
+    }
+    return emitted;
+}
+
+size_t DetectionHistory::size(size_t radar) const
+{
+    const RadarHistory &history = radars[radar];
+    return history.sealed_count + history.open[TIME].size();
+}
+
+size_t DetectionHistory::size() const
+{
+    size_t total = 0;
+    for (size_t r = 0; r < radars.size(); r++)
+        total += size(r);
+    return total;
+}
+
+size_t DetectionHistory::bytes() const
+{
+    size_t total = 0;
+    for (const RadarHistory &history : radars)
+    {
+        for (const vector<uint8_t> &page : history.pages)
+            total += page.size();
+        total += history.blocks.size() * sizeof(Block);
+        total += history.open[TIME].size() * FIELD_COUNT * sizeof(int64_t);
+    }
+    return total;
+}
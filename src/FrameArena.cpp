@@ -0,0 +1,46 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+FrameArena::FrameArena(size_t capacity)
+    : block(new char[capacity]),
+      block_size(capacity),
+      offset(0),
+      used_bytes(0),
+      high_water(0)
+{
+}
+
+void *FrameArena::allocateBytes(size_t size, size_t align)
+{
+    // Alignment is at most alignof(max_align_t), which new[] already satisfies
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+    size_t start = ((base + offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    used_bytes += size + (start - offset);
+
+    if (start + size <= block_size)
+    {
+        offset = start + size;
+        return block.get() + start;
+    }
+
+    overflow.emplace_back(new char[size]);
+    return overflow.back().get();
+}
+
+void FrameArena::reset()
+{
+    high_water = max(high_water, used_bytes);
+    if (!overflow.empty())
+    {
+        // Grow once to fit the worst step seen so far
+        overflow.clear();
+        block_size = max(block_size * 2, high_water);
+        block.reset(new char[block_size]);
+    }
+    offset = 0;
+    used_bytes = 0;
+}
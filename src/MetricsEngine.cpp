@@ -0,0 +1,413 @@
+#include "MetricsEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+    void printStats(ostream &out, const char *name, const ErrorStats &stats)
+    {
+        out << "  " << setw(16) << left << name << right
+            << " n=" << setw(8) << stats.count
+            << " mean=" << setw(9) << stats.mean
+            << " std=" << setw(9) << stats.stddev()
+            << " rms=" << setw(9) << stats.rms()
+            << " max=" << setw(9) << stats.max_abs << "\n";
+    }
+}
+
+void ErrorStats::add(double error)
+{
+    count++;
+    double delta = error - mean;
+    mean += delta / count;
+    m2 += delta * (error - mean);
+    max_abs = max(max_abs, fabs(error));
+}
+
+double ErrorStats::stddev() const
+{
+    return sqrt(variance());
+}
+
+double ErrorStats::rms() const
+{
+    if (count == 0)
+        return 0.0;
+    return sqrt(mean * mean + m2 / count);
+}
+
+MetricsEngine::MetricsEngine(const MetricsConfig &config)
+    : config(config),
+      last_ospa(0.0),
+      last_gospa(0.0)
+{
+}
+
+MetricsEngine::~MetricsEngine()
+{
+    {
+        lock_guard<mutex> lock(pool_mutex);
+        pool_stopping = true;
+    }
+    work_ready.notify_all();
+    for (thread &worker : workers)
+        worker.join();
+}
+
+void MetricsEngine::reset()
+{
+    radars.clear();
+    passes.clear();
+    detected_ids.clear();
+    ospa = ErrorStats();
+    gospa = ErrorStats();
+    gospa_totals = GospaTotals();
+    last_ospa = 0.0;
+    last_gospa = 0.0;
+}
+
+bool MetricsEngine::evaluate(const Simulation &simulation)
+{
+    const vector<Radar> &sim_radars = simulation.getRadars();
+    step_views.resize(sim_radars.size());
+    for (size_t r = 0; r < sim_radars.size(); r++)
+        step_views[r] = simulation.getStepDetections(r);
+    return evaluate(sim_radars, simulation.getTargets(), step_views, simulation.getSimTime());
+}
+
+bool MetricsEngine::evaluate(const vector<Radar> &sim_radars, const vector<Body> &targets,
+                             Span<const Span<const Detection>> detections, float current_time)
+{
+    if (detections.size() != sim_radars.size())
+    {
+        cerr << "\033[31m" << "Metrics got detections for " << detections.size() << " radars, expected "
+             << sim_radars.size() << "\033[0m\n";
+        return false;
+    }
+
+    // Accumulators are sized before any worker touches them
+    if (radars.size() < sim_radars.size())
+    {
+        radars.resize(sim_radars.size());
+        passes.resize(sim_radars.size());
+        detected_ids.resize(sim_radars.size());
+        for (size_t r = 0; r < sim_radars.size(); r++)
+        {
+            size_t bins = max<size_t>(1, (size_t)ceil(sim_radars[r].get_max_range() / config.range_bin));
+            radars[r].opportunities.resize(bins, 0);
+            radars[r].hits.resize(bins, 0);
+        }
+    }
+    for (auto &radar_passes : passes)
+        if (radar_passes.size() < targets.size())
+            radar_passes.resize(targets.size());
+
+    // Radars share nothing, each thread takes a contiguous run of them. A handful
+    // of radars is less work than waking the workers
+    size_t count = sim_radars.size();
+    size_t threads = min<size_t>(max(config.threads, 1u), count);
+    if (threads <= 1 || count < config.min_parallel_radars)
+    {
+        for (size_t r = 0; r < count; r++)
+            evaluateRadar(r, sim_radars[r], targets, detections[r], current_time);
+        return true;
+    }
+
+    size_t chunk = (count + threads - 1) / threads;
+    runChunks(threads, [&](size_t index) {
+        for (size_t r = index * chunk; r < min((index + 1) * chunk, count); r++)
+            evaluateRadar(r, sim_radars[r], targets, detections[r], current_time);
+    });
+    return true;
+}
+
+void MetricsEngine::runChunks(size_t chunks, const function<void(size_t)> &job)
+{
+    {
+        unique_lock<mutex> lock(pool_mutex);
+        while (workers.size() + 1 < chunks)
+            workers.emplace_back(&MetricsEngine::workerLoop, this, workers.size() + 1);
+        pool_job = &job;
+        pool_chunks = chunks;
+        pool_pending = workers.size();
+        pool_generation++;
+    }
+    work_ready.notify_all();
+
+    job(0);
+
+    unique_lock<mutex> lock(pool_mutex);
+    work_done.wait(lock, [this] { return pool_pending == 0; });
+    pool_job = nullptr;
+}
+
+void MetricsEngine::workerLoop(size_t chunk)
+{
+    unique_lock<mutex> lock(pool_mutex);
+    // Workers are started by runChunks, so the first step they see is the current one
+    uint64_t seen = pool_generation - 1;
+    while (true)
+    {
+        work_ready.wait(lock, [&] { return pool_stopping || pool_generation != seen; });
+        if (pool_stopping)
+            return;
+        seen = pool_generation;
+
+        const function<void(size_t)> *job = pool_job;
+        bool active = chunk < pool_chunks;
+        lock.unlock();
+        if (active)
+            (*job)(chunk);
+        lock.lock();
+
+        if (--pool_pending == 0)
+            work_done.notify_one();
+    }
+}
+
+void MetricsEngine::evaluateRadar(size_t index, const Radar &radar, const vector<Body> &targets,
+                                  Span<const Detection> detections, float current_time)
+{
+    RadarMetrics &metrics = radars[index];
+    vector<uint32_t> &ids = detected_ids[index];
+    ids.clear();
+
+    for (const Detection &det : detections)
+    {
+        if (det.target_id < 0 || (size_t)det.target_id >= targets.size())
+        {
+            metrics.false_plots++;
+            continue;
+        }
+        ids.push_back(det.target_id);
+
+        // Truth at the detection time, along the path the target took during the step
+        const Body &target = targets[det.target_id];
+        const float *pos = target.pos_data();
+        const float *vel = target.vel_data();
+        float back = current_time - det.timestamp;
+        float x = pos[0] - vel[0] * back;
+        float y = pos[1] - vel[1] * back;
+
+        metrics.range.add(det.distance - radar.distanceTo(x, y));
+        metrics.bearing.add(BeamGeometry::wrap180(det.azimuth - radar.azimuthTo(x, y)));
+        metrics.radial_velocity.add(det.radial_velocity - radar.radialVelocity(x, y, vel[0], vel[1]));
+    }
+    sort(ids.begin(), ids.end());
+
+    // Pd: a pass opens when the beam first sweeps over the target and is scored
+    // on the first step the target is out of the beam again
+    vector<Pass> &radar_passes = passes[index];
+    const size_t bins = metrics.opportunities.size();
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        Pass &pass = radar_passes[i];
+
+        float time_before_end;
+        bool in_beam = radar.findBeamCrossing(targets[i], time_before_end);
+        float range = 0;
+        if (in_beam)
+        {
+            const float *pos = targets[i].pos_data();
+            const float *vel = targets[i].vel_data();
+            range = radar.distanceTo(pos[0] - vel[0] * time_before_end, pos[1] - vel[1] * time_before_end);
+            in_beam = range <= radar.get_max_range();
+        }
+
+        if (!in_beam)
+        {
+            if (pass.bin >= 0)
+            {
+                metrics.opportunities[pass.bin]++;
+                metrics.hits[pass.bin] += pass.hit;
+                pass.bin = -1;
+            }
+            continue;
+        }
+
+        if (pass.bin < 0)
+        {
+            pass.bin = (int32_t)min((size_t)(range / config.range_bin), bins - 1);
+            pass.hit = false;
+        }
+        if (!pass.hit && binary_search(ids.begin(), ids.end(), (uint32_t)i))
+            pass.hit = true;
+    }
+}
+
+double MetricsEngine::scoreTracks(Span<const TrackEstimate> tracks, const vector<Body> &truth)
+{
+    const double c = config.cutoff;
+    const double p = config.order;
+    const double cp = pow(c, p);
+
+    const size_t m = truth.size();
+    const size_t n = tracks.size();
+    if (m == 0 && n == 0)
+    {
+        last_ospa = last_gospa = 0.0;
+        ospa.add(0.0);
+        gospa.add(0.0);
+        return 0.0;
+    }
+
+    // The smaller set goes on the rows so every row gets a column
+    bool truth_rows = m <= n;
+    size_t rows = truth_rows ? m : n;
+    size_t cols = truth_rows ? n : m;
+
+    cost.resize(rows * cols);
+    for (size_t i = 0; i < rows; i++)
+    {
+        for (size_t j = 0; j < cols; j++)
+        {
+            const float *pos = truth[truth_rows ? i : j].pos_data();
+            const TrackEstimate &track = tracks[truth_rows ? j : i];
+            double d = hypot(pos[0] - track.x, pos[1] - track.y);
+            // Pairs beyond the cutoff cost the same as leaving both unassigned
+            cost[i * cols + j] = pow(min(d, c), p);
+        }
+    }
+
+    double assigned = rows > 0 ? assign(rows, cols) : 0.0;
+    size_t unassigned = cols - rows;
+
+    // OSPA: cutoff for every unassigned element, normalised by the larger set
+    last_ospa = pow((assigned + cp * unassigned) / cols, 1.0 / p);
+
+    // GOSPA (alpha = 2): half the cutoff for every missed or false element
+    double localization = 0;
+    size_t capped = 0;
+    for (size_t i = 0; i < rows; i++)
+    {
+        double pair = cost[i * cols + assignment[i]];
+        if (pair < cp)
+            localization += pair;
+        else
+            capped++;
+    }
+    size_t missed = capped + (truth_rows ? 0 : unassigned);
+    size_t false_tracks = capped + (truth_rows ? unassigned : 0);
+    last_gospa = pow(localization + cp / 2 * (missed + false_tracks), 1.0 / p);
+
+    ospa.add(last_ospa);
+    gospa.add(last_gospa);
+    gospa_totals.localization += localization;
+    gospa_totals.missed += missed;
+    gospa_totals.false_tracks += false_tracks;
+    return last_ospa;
+}
+
+double MetricsEngine::assign(size_t rows, size_t cols)
+{
+    // Shortest augmenting paths with row/column potentials, O(rows^2 cols).
+    // Index 0 is a virtual column, rows and columns are 1-based inside
+    const double inf = numeric_limits<double>::infinity();
+    u.assign(rows + 1, 0.0);
+    v.assign(cols + 1, 0.0);
+    match.assign(cols + 1, 0);
+    way.assign(cols + 1, 0);
+
+    for (size_t i = 1; i <= rows; i++)
+    {
+        match[0] = i;
+        size_t j0 = 0;
+        minv.assign(cols + 1, inf);
+        used.assign(cols + 1, 0);
+        do
+        {
+            used[j0] = 1;
+            size_t i0 = match[j0], j1 = 0;
+            double delta = inf;
+            for (size_t j = 1; j <= cols; j++)
+            {
+                if (used[j])
+                    continue;
+                double cur = cost[(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+                if (cur < minv[j])
+                {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta)
+                {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (size_t j = 0; j <= cols; j++)
+            {
+                if (used[j])
+                {
+                    u[match[j]] += delta;
+                    v[j] -= delta;
+                }
+                else
+                    minv[j] -= delta;
+            }
+            j0 = j1;
+        } while (match[j0] != 0);
+
+        do
+        {
+            size_t j1 = way[j0];
+            match[j0] = match[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    assignment.assign(rows, 0);
+    double total = 0;
+    for (size_t j = 1; j <= cols; j++)
+    {
+        if (match[j] != 0)
+        {
+            assignment[match[j] - 1] = j - 1;
+            total += cost[(match[j] - 1) * cols + (j - 1)];
+        }
+    }
+    return total;
+}
+
+void MetricsEngine::report(ostream &out) const
+{
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    out << fixed << setprecision(3);
+
+    for (size_t r = 0; r < radars.size(); r++)
+    {
+        const RadarMetrics &metrics = radars[r];
+        out << "Radar " << r << "\n";
+        printStats(out, "range (m)", metrics.range);
+        printStats(out, "bearing (deg)", metrics.bearing);
+        printStats(out, "radial vel (m/s)", metrics.radial_velocity);
+        out << "  false plots " << metrics.false_plots << "\n";
+        out << "  Pd by range:";
+        for (size_t b = 0; b < metrics.opportunities.size(); b++)
+        {
+            if (metrics.opportunities[b] == 0)
+                continue;
+            out << " [" << b * config.range_bin << "," << (b + 1) * config.range_bin << ")="
+                << metrics.pd(b) << "/" << metrics.opportunities[b];
+        }
+        out << "\n";
+    }
+
+    if (ospa.count > 0)
+    {
+        out << "Tracks (c=" << config.cutoff << ", p=" << config.order << ")\n";
+        printStats(out, "OSPA", ospa);
+        printStats(out, "GOSPA", gospa);
+        out << "  GOSPA missed " << gospa_totals.missed << ", false " << gospa_totals.false_tracks << "\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,340 @@
+#include "PlotPublisher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+    void put16(uint8_t *p, uint16_t v)
+    {
+        p[0] = v >> 8;
+        p[1] = v;
+    }
+
+    void put24(uint8_t *p, uint32_t v)
+    {
+        p[0] = v >> 16;
+        p[1] = v >> 8;
+        p[2] = v;
+    }
+
+    uint16_t get16(const uint8_t *p) { return (p[0] << 8) | p[1]; }
+    uint32_t get24(const uint8_t *p) { return (p[0] << 16) | (p[1] << 8) | p[2]; }
+
+    // Rounds value / lsb to the nearest integer and clamps it into [lo, hi]
+    long quantize(float value, float lsb, long lo, long hi)
+    {
+        long q = lround(value / lsb);
+        return max(lo, min(hi, q));
+    }
+
+    void encodeRecord(uint8_t *p, const Detection &det)
+    {
+        uint16_t id = (det.target_id < 0 || det.target_id >= PlotFormat::UNKNOWN_TARGET)
+                          ? PlotFormat::UNKNOWN_TARGET
+                          : det.target_id;
+        // Time of day style wrap-around, the consumer knows the epoch
+        uint32_t time = static_cast<uint32_t>(llround(det.timestamp * 128.0)) & 0xFFFFFF;
+        float azimuth = fmod(det.azimuth, 360.0f);
+        if (azimuth < 0)
+            azimuth += 360.0f;
+
+        put16(p, id);
+        put24(p + 2, time);
+        put24(p + 5, quantize(det.distance, 1.0f / 128, 0, 0xFFFFFF));
+        put16(p + 8, quantize(azimuth, 360.0f / 65536, 0, 65536) & 0xFFFF);
+        put16(p + 10, static_cast<uint16_t>(quantize(det.radial_velocity, 1.0f / 16, -32768, 32767)));
+    }
+
+    size_t writeHeader(uint8_t *p, uint16_t radar_id, size_t count)
+    {
+        size_t size = PlotFormat::HEADER_SIZE + count * PlotFormat::RECORD_SIZE;
+        p[0] = PlotFormat::CATEGORY;
+        put16(p + 1, size);
+        put16(p + 3, radar_id);
+        return size;
+    }
+}
+
+size_t PlotFormat::encode(uint16_t radar_id, const Detection *detections, size_t count, uint8_t *out)
+{
+    count = min(count, MAX_RECORDS);
+    for (size_t i = 0; i < count; i++)
+        encodeRecord(out + HEADER_SIZE + i * RECORD_SIZE, detections[i]);
+    return writeHeader(out, radar_id, count);
+}
+
+bool PlotFormat::decode(const uint8_t *data, size_t size, uint16_t &radar_id, vector<Detection> &out)
+{
+    if (size < HEADER_SIZE || data[0] != CATEGORY)
+        return false;
+    size_t length = get16(data + 1);
+    if (length < HEADER_SIZE || length > size || (length - HEADER_SIZE) % RECORD_SIZE != 0)
+        return false;
+
+    radar_id = get16(data + 3);
+    for (size_t offset = HEADER_SIZE; offset < length; offset += RECORD_SIZE)
+    {
+        const uint8_t *p = data + offset;
+        Detection det;
+        det.detected = true;
+        uint16_t id = get16(p);
+        det.target_id = id == UNKNOWN_TARGET ? -1 : id;
+        det.timestamp = get24(p + 2) / 128.0f;
+        det.distance = get24(p + 5) / 128.0f;
+        det.azimuth = get16(p + 8) * (360.0f / 65536);
+        det.radial_velocity = static_cast<int16_t>(get16(p + 10)) / 16.0f;
+        det.lifespan = 0;
+        out.push_back(det);
+    }
+    return true;
+}
+
+PlotPublisher::PlotPublisher(size_t queue_capacity)
+    : queue(queue_capacity),
+      running(false),
+      fd(-1),
+      address_len(0),
+      pending(MAX_DATAGRAMS * PlotFormat::MAX_RECORDS),
+      buffers(MAX_DATAGRAMS * PlotFormat::MAX_BLOCK_SIZE),
+      iovecs(MAX_DATAGRAMS),
+      messages(MAX_DATAGRAMS),
+      block_radar(MAX_DATAGRAMS),
+      block_records(MAX_DATAGRAMS),
+      sent_plots(0),
+      sent_datagrams(0),
+      dropped_plots(0)
+{
+    memset(&address, 0, sizeof(address));
+}
+
+PlotPublisher::~PlotPublisher()
+{
+    stop();
+    if (fd >= 0)
+        close(fd);
+}
+
+bool PlotPublisher::release()
+{
+    // The I/O thread owns the socket while it runs
+    if (running)
+    {
+        cerr << "\033[31m" << "Plot publisher is running, stop it before opening another endpoint" << "\033[0m\n";
+        return false;
+    }
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    return true;
+}
+
+bool PlotPublisher::openUdp(const string &host, uint16_t port)
+{
+    if (!release())
+        return false;
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *result = nullptr;
+    if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &result) != 0 || !result)
+    {
+        cerr << "\033[31m" << "Cannot resolve plot destination " << host << "\033[0m\n";
+        return false;
+    }
+
+    fd = socket(result->ai_family, SOCK_DGRAM, 0);
+    if (fd >= 0)
+    {
+        memcpy(&address, result->ai_addr, result->ai_addrlen);
+        address_len = result->ai_addrlen;
+    }
+    freeaddrinfo(result);
+    return fd >= 0;
+}
+
+bool PlotPublisher::openUnix(const string &path)
+{
+    if (!release())
+        return false;
+
+    sockaddr_un addr = {};
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0)
+        return false;
+    memcpy(&address, &addr, sizeof(addr));
+    address_len = sizeof(addr);
+    return true;
+}
+
+bool PlotPublisher::open(const string &endpoint)
+{
+    if (endpoint.rfind("unix:", 0) == 0)
+        return openUnix(endpoint.substr(5));
+
+    if (endpoint.rfind("udp:", 0) == 0)
+    {
+        size_t colon = endpoint.rfind(':');
+        if (colon > 4)
+        {
+            string port = endpoint.substr(colon + 1);
+            char *end = nullptr;
+            errno = 0;
+            long value = strtol(port.c_str(), &end, 10);
+            if (!port.empty() && *end == '\0' && errno == 0 && value > 0 && value <= 65535)
+                return openUdp(endpoint.substr(4, colon - 4), (uint16_t)value);
+            cerr << "\033[31m" << "Invalid port in plot endpoint " << endpoint << "\033[0m\n";
+            return false;
+        }
+    }
+
+    cerr << "\033[31m" << "Unknown plot endpoint " << endpoint << "\033[0m\n";
+    return false;
+}
+
+void PlotPublisher::start()
+{
+    if (fd < 0 || running)
+        return;
+    running = true;
+    io_thread = thread(&PlotPublisher::run, this);
+}
+
+void PlotPublisher::stop()
+{
+    running = false;
+    if (io_thread.joinable())
+        io_thread.join();
+}
+
+bool PlotPublisher::publish(uint16_t radar_id, const Detection &detection)
+{
+    if (queue.push({radar_id, detection}))
+        return true;
+    dropped_plots++;
+    return false;
+}
+
+size_t PlotPublisher::publish(uint16_t radar_id, const Detection *detections, size_t count)
+{
+    size_t queued = 0;
+    for (size_t i = 0; i < count; i++)
+        queued += publish(radar_id, detections[i]);
+    return queued;
+}
+
+void PlotPublisher::run()
+{
+    while (true)
+    {
+        // Read the flag before draining so nothing queued before stop() is lost
+        bool keep_running = running;
+        size_t n = queue.pop(pending.data(), pending.size());
+        if (n > 0)
+        {
+            send(pending.data(), n);
+            continue;
+        }
+        if (!keep_running)
+            break;
+        this_thread::sleep_for(chrono::microseconds(50));
+    }
+}
+
+bool PlotPublisher::send(const Plot *plots, size_t count)
+{
+    bool ok = true;
+    size_t datagrams = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        // Append to the open block of the same radar, so interleaved radars still batch well
+        size_t d = 0;
+        while (d < datagrams &&
+               (block_radar[d] != plots[i].radar_id || block_records[d] == PlotFormat::MAX_RECORDS))
+            d++;
+
+        if (d == datagrams)
+        {
+            if (datagrams == MAX_DATAGRAMS)
+            {
+                ok = flush(datagrams) && ok;
+                datagrams = 0;
+                d = 0;
+            }
+            block_radar[d] = plots[i].radar_id;
+            block_records[d] = 0;
+            datagrams++;
+        }
+
+        uint8_t *buffer = buffers.data() + d * PlotFormat::MAX_BLOCK_SIZE;
+        encodeRecord(buffer + PlotFormat::HEADER_SIZE + block_records[d] * PlotFormat::RECORD_SIZE, plots[i].detection);
+        block_records[d]++;
+    }
+    return flush(datagrams) && ok;
+}
+
+bool PlotPublisher::flush(size_t datagrams)
+{
+    for (size_t d = 0; d < datagrams; d++)
+    {
+        uint8_t *buffer = buffers.data() + d * PlotFormat::MAX_BLOCK_SIZE;
+        iovecs[d].iov_base = buffer;
+        iovecs[d].iov_len = writeHeader(buffer, block_radar[d], block_records[d]);
+
+        mmsghdr &msg = messages[d];
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_hdr.msg_name = &address;
+        msg.msg_hdr.msg_namelen = address_len;
+        msg.msg_hdr.msg_iov = &iovecs[d];
+        msg.msg_hdr.msg_iovlen = 1;
+    }
+
+    size_t sent = 0;
+    while (sent < datagrams)
+    {
+        int n = sendmmsg(fd, messages.data() + sent, datagrams - sent, 0);
+        if (n > 0)
+        {
+            sent += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        // A full socket buffer is back-pressure, wait for room instead of dropping
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS))
+        {
+            pollfd writable = {fd, POLLOUT, 0};
+            if (poll(&writable, 1, SEND_TIMEOUT_MS) > 0)
+                continue;
+        }
+        break;
+    }
+
+    for (size_t d = 0; d < datagrams; d++)
+    {
+        if (d < sent)
+            sent_plots += block_records[d];
+        else
+            dropped_plots += block_records[d];
+    }
+    sent_datagrams += sent;
+    return sent == datagrams;
+}
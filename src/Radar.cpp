@@ -1,6 +1,7 @@
 #include "Radar.h"
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <random>
 #include <iostream>
 
@@ -16,18 +17,23 @@ Radar::Radar(vector<float> pos, float max_range, float scan_interval, float beam
       azimuth_noise_std(0.5f),
       velocity_noise_std(0.5f),
       detection_prob(0.95f),
+      sweep_start(0.0f),
+      sweep_deg(0.0f),
+      step_dt(0.0f),
       generator(random_device{}()),
       norm_dist(0.0f, 0.5f),
-      uniform_dist(0.0f, 0.5f)
+      uniform_dist(0.0f, 1.0f)
 {
 }
 
 void Radar::update(float dt)
 {
     float deg = 360.0f * scan_interval * dt;
-    if (deg + scan_angle >= 360)
-        scan_angle -= 360;
-    scan_angle += deg;
+    // Remember the swept interval, scan() tests the whole of it
+    sweep_start = scan_angle;
+    sweep_deg = deg;
+    step_dt = dt;
+    scan_angle = fmod(scan_angle + deg, 360.0f);
     //  detections.clear();
     for (auto it = detections.begin(); it != detections.end();)
     {
@@ -42,19 +48,48 @@ void Radar::update(float dt)
 void Radar::reset()
 {
     scan_angle = 0.0f;
+    sweep_start = 0.0f;
+    sweep_deg = 0.0f;
+    step_dt = 0.0f;
+}
+
+void Radar::reseed(unsigned seed)
+{
+    generator.seed(seed);
+    norm_dist.reset();
+    uniform_dist.reset();
 }
 
 float Radar::calculateDistance(const Body &target) const
 {
-    float dx = target.get_pos()[0] - pos[0];
-    float dy = target.get_pos()[1] - pos[1];
-    return sqrt(dx * dx + dy * dy);
+    const float *target_pos = target.pos_data();
+    return distanceTo(target_pos[0], target_pos[1]);
 }
 
 float Radar::calculateAzimuth(const Body &target) const
 {
-    float dx = target.get_pos()[0] - pos[0];
-    float dy = target.get_pos()[1] - pos[1];
+    const float *target_pos = target.pos_data();
+    return azimuthTo(target_pos[0], target_pos[1]);
+}
+
+float Radar::calculateVelocity(const Body &target) const
+{
+    const float *target_pos = target.pos_data();
+    const float *vel = target.vel_data();
+    return radialVelocity(target_pos[0], target_pos[1], vel[0], vel[1]);
+}
+
+float Radar::distanceTo(float x, float y) const
+{
+    float dx = x - pos[0];
+    float dy = y - pos[1];
+    return sqrt(dx * dx + dy * dy);
+}
+
+float Radar::azimuthTo(float x, float y) const
+{
+    float dx = x - pos[0];
+    float dy = y - pos[1];
     float rad = atan2(dy, dx);
     float deg = rad * 180.0f / M_PI;
     if (deg < 0.0f && deg > -180.0f)
@@ -62,11 +97,10 @@ float Radar::calculateAzimuth(const Body &target) const
     return deg;
 }
 
-float Radar::calculateVelocity(const Body &target) const
+float Radar::radialVelocity(float x, float y, float vx, float vy) const
 {
-    auto vel = target.get_vel();
-    float dx = target.get_pos()[0] - pos[0];
-    float dy = target.get_pos()[1] - pos[1];
+    float dx = x - pos[0];
+    float dy = y - pos[1];
     float distance = sqrt(dx * dx + dy * dy);
 
     if (distance < 0.001f)
@@ -76,25 +110,32 @@ float Radar::calculateVelocity(const Body &target) const
     float ux = dx / distance;
     float uy = dy / distance;
 
-    return vel[0] * ux + vel[1] * uy;
+    return vx * ux + vy * uy;
 }
 
-bool Radar::shouldDetect(float distance, float azimuth)
+bool Radar::findBeamCrossing(const Body &target, float &time_before_end) const
 {
-    float degToCompareUp = scan_angle + beam_width / 2;
-    float degToCompareDown = scan_angle - beam_width / 2;
-    if (degToCompareUp >= 360)
-        degToCompareUp -= 360;
-    if (degToCompareDown < 0)
-        ;
-    degToCompareUp += 360;
+    const float *p1 = target.pos_data();
+    const float *vel = target.vel_data();
+    float half_beam = beam_width / 2;
 
-    if (azimuth > scan_angle + beam_width / 2 ||
-        azimuth < scan_angle - beam_width / 2)
-        return false;
+    // The integrator moves bodies with their end-of-step velocity, so this is the
+    // exact path over the step
+    float x0 = p1[0] - vel[0] * step_dt;
+    float y0 = p1[1] - vel[1] * step_dt;
+    float az0 = azimuthTo(x0, y0);
+    float az1 = azimuthTo(p1[0], p1[1]);
+
+    return BeamGeometry::sweepCrossing(az0, az1, sweep_start, sweep_deg, scan_angle, half_beam, step_dt,
+                                       time_before_end);
+}
+
+bool Radar::shouldDetect(float distance)
+{
     // simulate probability of detection according to range, sigmoid based
     float prob = detection_prob * (2 / (1 + pow(M_E, distance * 0.0001)));
-    return (distance < max_range) && (rand() % 100 < detection_prob * 100);
+    // drawn from the radar's own engine so its state can be checkpointed
+    return (distance < max_range) && (uniform_dist(generator) < detection_prob);
 }
 
 Detection Radar::scan(const Body &target, int target_id, float current_time)
@@ -103,13 +144,23 @@ Detection Radar::scan(const Body &target, int target_id, float current_time)
     det.timestamp = current_time;
     det.target_id = target_id;
 
-    float distance = calculateDistance(target);
-    float azimuth = calculateAzimuth(target);
-    float radial_velocity = calculateVelocity(target);
-    bool isDetected = shouldDetect(distance, azimuth);
+    // Measure the target where it was when the beam passed over it
+    float time_before_end = 0;
+    bool inBeam = findBeamCrossing(target, time_before_end);
+
+    const float *target_pos = target.pos_data();
+    const float *vel = target.vel_data();
+    float x = target_pos[0] - vel[0] * time_before_end;
+    float y = target_pos[1] - vel[1] * time_before_end;
+
+    float distance = distanceTo(x, y);
+    float azimuth = azimuthTo(x, y);
+    float radial_velocity = radialVelocity(x, y, vel[0], vel[1]);
+    bool isDetected = inBeam && shouldDetect(distance);
 
     if (distance <= max_range && isDetected)
     {
+        det.timestamp = current_time - time_before_end;
         det.detected = true;
         det.distance = distance + norm_dist(generator) * distance_noise_std;
         det.azimuth = azimuth + norm_dist(generator) * azimuth_noise_std;
@@ -130,34 +181,114 @@ Detection Radar::scan(const Body &target, int target_id, float current_time)
     return det;
 }
 
-// Checks if detection has a close by existing detection
-bool Radar::checkDetection(Detection detection, float azimuth_threshold, float distance_threshold)
+// Checks that the detection is new, i.e. has no close by existing detection
+bool Radar::checkDetection(const Detection &detection, float azimuth_threshold, float distance_threshold)
+{
+    if (!detection.detected)
+        return false;
+
+    for (auto &d : detections)
+        if (BeamGeometry::isDuplicate(detection.distance - d.distance, detection.azimuth - d.azimuth,
+                                      distance_threshold, azimuth_threshold))
+            return false;
+    return true;
+}
+
+Span<const Detection> Radar::scan(const vector<Body> &targets, float current_time, FrameArena &arena)
 {
     for (auto &d : detections)
     {
-        float distance_delta = detection.distance - d.distance;
-        float azimuth_delta = detection.azimuth - d.azimuth;
+        d.detected = false;
+    }
+
+    // Every target could be detected at most once, so this bounds the step's output
+    Span<Detection> step_detections = arena.allocate<Detection>(targets.size());
+    size_t count = 0;
 
-        if (abs(distance_delta) > distance_threshold ||
-            abs(azimuth_delta) > azimuth_threshold)
-            return true;
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        Detection det = scan(targets[i], i, current_time);
+        if (checkDetection(det))
+        {
+            detections.push_back(det);
+            step_detections[count++] = det;
+        }
     }
-    return false;
+
+    return Span<const Detection>(step_detections.data(), count);
 }
 
-vector<Detection> Radar::scan(const vector<Body> &targets, float current_time)
+Span<const Detection> Radar::scan(const vector<Body> &targets, Span<const uint32_t> indices, float current_time, FrameArena &arena)
 {
     for (auto &d : detections)
     {
         d.detected = false;
     }
 
-    for (size_t i = 0; i < targets.size(); i++)
+    Span<Detection> step_detections = arena.allocate<Detection>(indices.size());
+    size_t count = 0;
+
+    for (uint32_t i : indices)
     {
         Detection det = scan(targets[i], i, current_time);
         if (checkDetection(det))
+        {
+            detections.push_back(det);
+            step_detections[count++] = det;
+        }
+    }
+
+    return Span<const Detection>(step_detections.data(), count);
+}
+
+Span<const Detection> Radar::record(Span<const Detection> candidates, FrameArena &arena)
+{
+    for (auto &d : detections)
+    {
+        d.detected = false;
+    }
+
+    Span<Detection> step_detections = arena.allocate<Detection>(candidates.size());
+    size_t count = 0;
+
+    for (const Detection &det : candidates)
+    {
+        if (checkDetection(det))
+        {
             detections.push_back(det);
+            step_detections[count++] = det;
+        }
     }
 
-    return detections;
-}
\ No newline at end of file
+    return Span<const Detection>(step_detections.data(), count);
+}
+
+float Radar::timeToBeamEntry(const Body &target) const
+{
+    const float *target_pos = target.pos_data();
+    const float *vel = target.vel_data();
+    float dx = target_pos[0] - pos[0];
+    float dy = target_pos[1] - pos[1];
+    float r2 = dx * dx + dy * dy;
+    float half_beam = beam_width / 2;
+
+    float ahead = fmod(azimuthTo(target_pos[0], target_pos[1]) - scan_angle, 360.0f);
+    if (ahead < 0)
+        ahead += 360.0f;
+    if (ahead <= half_beam || ahead >= 360.0f - half_beam)
+        return 0.0f;
+
+    // Angular rate of the target as seen from the radar, deg/s
+    float target_rate = r2 > 1e-6f ? (dx * vel[1] - dy * vel[0]) / r2 * 180.0f / M_PI : 0.0f;
+    float beam_rate = 360.0f * scan_interval;
+    if (beam_rate <= 0)
+        return -1.0f;
+    // Close to the radar the bearing swings too fast for a linear prediction,
+    // treat the target as always about to be reached
+    if (fabs(target_rate) > beam_rate / 2)
+        return 0.0f;
+
+    float closing_rate = beam_rate - target_rate;
+
+    return (ahead - half_beam) / closing_rate;
+}
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -29,7 +30,13 @@ Renderer::Renderer(float screen_height,
       isDragging(false),
       currentMousePosition(sf::Vector2i(0, 0)),
       previousMousePosition(sf::Vector2i(0, 0)),
-      colors{sf::Color::Green, sf::Color::Red}
+      colors{sf::Color::Green, sf::Color::Red},
+      ppi_splats(sf::Quads),
+      ppi_enabled(false),
+      ppi_decay(3.0f),
+      trails(64, 4),
+      trail_buffer(sf::Lines, sf::VertexBuffer::Stream),
+      trail_buffer_enabled(sf::VertexBuffer::isAvailable())
 {
     window.setFramerateLimit(60);
     if (!load_font())
@@ -37,6 +44,19 @@ Renderer::Renderer(float screen_height,
         cerr << "\033[31m" << "Error loading font into the renderer" << "\033[0m\n";
         exit(1);
     }
+
+    create_ppi(screen_width, screen_height);
+}
+
+bool Renderer::create_ppi(unsigned width, unsigned height)
+{
+    ppi_splats.clear();
+    ppi_enabled = ppi.create(width, height);
+    if (ppi_enabled)
+        ppi.clear(sf::Color::Black);
+    else
+        cerr << "\033[31m" << "Error creating the PPI texture, phosphor layer disabled" << "\033[0m\n";
+    return ppi_enabled;
 }
 
 bool Renderer::load_font()
@@ -135,7 +155,7 @@ void Renderer::draw_radar(const Radar &radar)
 }
 
 void Renderer::draw_body(const Body &body,
-                         Detection detected)
+                         const Detection &detected)
 {
     auto pos = body.get_pos();
     sf::Vector2f screenPos = worldToScreen(pos[0], pos[1]);
@@ -207,6 +227,118 @@ void Renderer::draw_body(const Body &body,
     }
 }
 
+void Renderer::add_returns(const Radar &radar, Span<const Detection> detections)
+{
+    if (!ppi_enabled)
+        return;
+
+    auto radar_pos = radar.get_pos();
+    const float size = 3.0f;
+    const sf::Color color(40, 255, 80);
+    for (const Detection &det : detections)
+    {
+        float x, y;
+        Phosphor::returnPosition(radar_pos[0], radar_pos[1], det, x, y);
+        sf::Vector2f p = worldToScreen(x, y);
+        ppi_splats.append(sf::Vertex(sf::Vector2f(p.x - size, p.y - size), color));
+        ppi_splats.append(sf::Vertex(sf::Vector2f(p.x + size, p.y - size), color));
+        ppi_splats.append(sf::Vertex(sf::Vector2f(p.x + size, p.y + size), color));
+        ppi_splats.append(sf::Vertex(sf::Vector2f(p.x - size, p.y + size), color));
+    }
+}
+
+void Renderer::draw_ppi()
+{
+    if (!ppi_enabled)
+        return;
+
+    if (!isPaused)
+    {
+        sf::Uint8 level = ppi_decay.advance(dt);
+        if (level > 0)
+        {
+            sf::RectangleShape decay(sf::Vector2f(ppi.getSize().x, ppi.getSize().y));
+            decay.setFillColor(sf::Color(level, level, level, 0));
+            ppi.draw(decay, sf::BlendMode(sf::BlendMode::One, sf::BlendMode::One, sf::BlendMode::ReverseSubtract));
+        }
+    }
+
+    // Burn in only the returns added since the last frame
+    if (ppi_splats.getVertexCount() > 0)
+    {
+        ppi.draw(ppi_splats, sf::BlendAdd);
+        ppi_splats.clear();
+    }
+    ppi.display();
+
+    sf::Sprite layer(ppi.getTexture());
+    window.draw(layer, sf::BlendAdd);
+}
+
+void Renderer::write_trail_row(size_t slot, bool visible)
+{
+    const size_t count = trails.getTargetCount();
+    const size_t length = trails.getLength();
+    const size_t prev = (slot + length - 1) % length;
+    const sf::Color color = visible ? sf::Color(0, 160, 255, 140) : sf::Color::Transparent;
+
+    sf::Vertex *row = trail_vertices.data() + slot * count * 2;
+    for (size_t t = 0; t < count; t++)
+    {
+        row[2 * t] = sf::Vertex(worldToScreen(trails.x(prev, t), trails.y(prev, t)), color);
+        row[2 * t + 1] = sf::Vertex(worldToScreen(trails.x(slot, t), trails.y(slot, t)), color);
+    }
+
+    if (trail_buffer_enabled && count > 0)
+        trail_buffer.update(row, count * 2, slot * count * 2);
+}
+
+void Renderer::record_trails(const vector<Body> &targets)
+{
+    if (trails.getTargetCount() != targets.size())
+    {
+        trails.reset(targets);
+        trail_vertices.assign(trails.getLength() * targets.size() * 2, sf::Vertex());
+        if (trail_buffer_enabled && !trail_buffer.create(trail_vertices.size()))
+            trail_buffer_enabled = false;
+
+        // Every sample is the current position, so all segments start out empty
+        for (size_t slot = 0; slot < trails.getLength(); slot++)
+            write_trail_row(slot, false);
+        return;
+    }
+
+    if (!trails.record(targets))
+        return;
+
+    size_t head = trails.getHead();
+    write_trail_row(head, true);
+    write_trail_row((head + 1) % trails.getLength(), false);
+}
+
+void Renderer::clear_trails()
+{
+    trails.clear();
+    trail_vertices.clear();
+}
+
+void Renderer::set_trail_config(size_t length, unsigned decimation)
+{
+    trails.configure(length, decimation);
+    trail_vertices.clear();
+}
+
+void Renderer::draw_trails()
+{
+    if (trail_vertices.empty())
+        return;
+
+    if (trail_buffer_enabled)
+        window.draw(trail_buffer);
+    else
+        window.draw(trail_vertices.data(), trail_vertices.size(), sf::Lines);
+}
+
 float Renderer::get_screen_height() { return screen_height; }
 
 float Renderer::get_screen_width() { return screen_width; }
@@ -226,16 +358,22 @@ void Renderer::close()
 void Renderer::reset()
 {
     sim_time = 0.0f;
+    ppi_splats.clear();
+    ppi_decay.reset();
+    if (ppi_enabled)
+        ppi.clear(sf::Color::Black);
+    clear_trails();
 }
 
-void Renderer::render(const Radar &radar, vector<Body> &targets, vector<Detection> &detections)
+void Renderer::render(const Radar &radar, const vector<Body> &targets, Span<const Detection> detections)
 {
     window.clear(sf::Color::Black);
     draw_grid();
+    draw_ppi();
+    draw_trails();
     draw_radar(radar);
 
-    // right now this is an issue - need to decide on how to store targets and detections
-    for (size_t i = 0; i < targets.size(); i++)
+    for (size_t i = 0; i < targets.size() && i < detections.size(); i++)
     {
         draw_body(targets[i], detections[i]);
     }
@@ -258,7 +396,7 @@ void Renderer::render(const Radar &radar, vector<Body> &targets, vector<Detectio
     window.draw(text);
 
     int detCount = 0;
-    for (Detection d : detections)
+    for (const Detection &d : detections)
         if (d.detected)
             detCount++;
 
@@ -267,7 +405,7 @@ void Renderer::render(const Radar &radar, vector<Body> &targets, vector<Detectio
     text.setPosition(10, 35);
     window.draw(text);
 
-    text.setString("SPACE: Pause  |  R: Reset  |  ESC: Quit");
+    text.setString("SPACE: Pause  |  R: Reset  |  S: Save  |  L: Load  |  ESC: Quit");
     text.setCharacterSize(12);
     text.setFillColor(sf::Color(200, 200, 200));
     text.setPosition(10, window.getSize().y - 20);
@@ -311,6 +449,8 @@ void Renderer::updateView(
     {
         sf::FloatRect visibleArea(0, 0, event->size.width, event->size.height);
         window.setView(sf::View(visibleArea));
+        // The layer is drawn 1:1 over the window, a stale size would stretch it
+        create_ppi(event->size.width, event->size.height);
     }
 }
 
@@ -0,0 +1,598 @@
+#include "ShardCluster.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+    // Wire format, native layout since both ends are the same binary on the same host.
+    // Every message is a header followed by `bytes` of records
+    enum MessageType : uint32_t
+    {
+        MSG_ADD_RADAR = 1, // RadarRecord, no reply
+        MSG_ADD_TARGETS,   // TargetRecord * count, no reply
+        MSG_STEP,          // value = dt, reply: emigrating TargetRecord * count, aux = targets kept
+        MSG_SCAN,          // uint32 radar index * count, reply: Candidate * count
+        MSG_GATHER,        // reply: TargetRecord * count
+        MSG_SHUTDOWN
+    };
+
+    struct MessageHeader
+    {
+        uint32_t type;
+        uint32_t count;
+        uint32_t aux;
+        uint32_t bytes;
+        float value;
+    };
+
+    struct TargetRecord
+    {
+        uint32_t id;
+        float pos[2];
+        float vel[2];
+        float accel[2];
+    };
+
+    struct RadarRecord
+    {
+        float pos[2];
+        float max_range;
+        float scan_interval;
+        float beam_width;
+    };
+
+    // Target the beam swept over during the step
+    struct Candidate
+    {
+        uint32_t radar;
+        TargetRecord target;
+    };
+
+    TargetRecord toRecord(const Body &body, uint32_t id)
+    {
+        TargetRecord record;
+        record.id = id;
+        copy(body.pos_data(), body.pos_data() + 2, record.pos);
+        copy(body.vel_data(), body.vel_data() + 2, record.vel);
+        copy(body.accel_data(), body.accel_data() + 2, record.accel);
+        return record;
+    }
+
+    Body toBody(const TargetRecord &record)
+    {
+        return Body({record.pos[0], record.pos[1]},
+                    {record.vel[0], record.vel[1]},
+                    {record.accel[0], record.accel[1]});
+    }
+
+    bool writeAll(int fd, const void *data, size_t size)
+    {
+        const char *p = static_cast<const char *>(data);
+        while (size > 0)
+        {
+            ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool readAll(int fd, void *data, size_t size)
+    {
+        char *p = static_cast<char *>(data);
+        while (size > 0)
+        {
+            ssize_t n = ::recv(fd, p, size, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= n;
+        }
+        return true;
+    }
+
+    bool sendMessage(int fd, uint32_t type, uint32_t count, uint32_t aux, float value, const void *payload, size_t bytes)
+    {
+        MessageHeader header = {type, count, aux, (uint32_t)bytes, value};
+        return writeAll(fd, &header, sizeof(header)) && (bytes == 0 || writeAll(fd, payload, bytes));
+    }
+
+    // Reads a reply of records of type T into arena memory
+    template <typename T>
+    bool receive(int fd, FrameArena &arena, Span<T> &records, uint32_t &aux)
+    {
+        MessageHeader header;
+        if (!readAll(fd, &header, sizeof(header)) || header.bytes != header.count * sizeof(T))
+            return false;
+        records = arena.allocate<T>(header.count);
+        aux = header.aux;
+        return header.bytes == 0 || readAll(fd, records.data(), header.bytes);
+    }
+}
+
+size_t ShardGrid::shardOf(float x, float y) const
+{
+    int col = (int)floor((x - min_x) / (max_x - min_x) * cols);
+    int row = (int)floor((y - min_y) / (max_y - min_y) * rows);
+    col = min(max(col, 0), (int)cols - 1);
+    row = min(max(row, 0), (int)rows - 1);
+    return (size_t)row * cols + col;
+}
+
+bool ShardGrid::intersects(size_t shard, float cx, float cy, float radius) const
+{
+    const float inf = numeric_limits<float>::infinity();
+    size_t col = shard % cols;
+    size_t row = shard / cols;
+    float cell_w = (max_x - min_x) / cols;
+    float cell_h = (max_y - min_y) / rows;
+
+    float x0 = col == 0 ? -inf : min_x + col * cell_w;
+    float x1 = col == cols - 1 ? inf : min_x + (col + 1) * cell_w;
+    float y0 = row == 0 ? -inf : min_y + row * cell_h;
+    float y1 = row == rows - 1 ? inf : min_y + (row + 1) * cell_h;
+
+    // Closest point of the cell to the center
+    float dx = cx - min(max(cx, x0), x1);
+    float dy = cy - min(max(cy, y0), y1);
+    return dx * dx + dy * dy <= radius * radius;
+}
+
+ShardCluster::ShardCluster(float dt, const ShardGrid &grid)
+    : grid(grid),
+      running(false),
+      target_count(0),
+      migrations(0),
+      scan_requests(0),
+      dt(dt),
+      sim_time(0.0f)
+{
+}
+
+ShardCluster::~ShardCluster()
+{
+    stop();
+}
+
+bool ShardCluster::start()
+{
+    if (running)
+        return true;
+
+    for (size_t s = 0; s < grid.count(); s++)
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        {
+            cerr << "\033[31m" << "Failed to create a shard socket: " << strerror(errno) << "\033[0m\n";
+            stop();
+            return false;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            cerr << "\033[31m" << "Failed to fork shard worker " << s << ": " << strerror(errno) << "\033[0m\n";
+            close(fds[0]);
+            close(fds[1]);
+            stop();
+            return false;
+        }
+        if (pid == 0)
+        {
+            // The worker keeps only its own end, so it sees EOF if the coordinator dies
+            close(fds[0]);
+            for (const Worker &worker : workers)
+                close(worker.fd);
+            serve(fds[1], s, grid);
+        }
+
+        close(fds[1]);
+        workers.push_back({pid, fds[0]});
+    }
+
+    radars.clear();
+    step_detections.clear();
+    merged = Span<const ClusterDetection>();
+    target_count = 0;
+    shard_targets.assign(grid.count(), 0);
+    migrations = 0;
+    scan_requests = 0;
+    sim_time = 0.0f;
+    running = true;
+    return true;
+}
+
+void ShardCluster::stop()
+{
+    for (const Worker &worker : workers)
+    {
+        sendMessage(worker.fd, MSG_SHUTDOWN, 0, 0, 0.0f, nullptr, 0);
+        close(worker.fd);
+    }
+    for (const Worker &worker : workers)
+        waitpid(worker.pid, nullptr, 0);
+    workers.clear();
+    running = false;
+}
+
+bool ShardCluster::fail(size_t shard)
+{
+    cerr << "\033[31m" << "Shard worker " << shard << " failed, stopping the cluster" << "\033[0m\n";
+    stop();
+    return false;
+}
+
+size_t ShardCluster::addRadar(const Radar &radar)
+{
+    if (!running)
+        return INVALID_ID;
+
+    vector<float> pos = radar.get_pos();
+    RadarRecord record = {{pos[0], pos[1]}, radar.get_max_range(), radar.getScanInterval(), radar.getBeamWidth()};
+    for (size_t s = 0; s < workers.size(); s++)
+        if (!sendMessage(workers[s].fd, MSG_ADD_RADAR, 1, 0, 0.0f, &record, sizeof(record)))
+        {
+            fail(s);
+            return INVALID_ID;
+        }
+
+    radars.push_back(radar);
+    radars.back().reset();
+    step_detections.resize(radars.size());
+    return radars.size() - 1;
+}
+
+size_t ShardCluster::addTarget(const Body &target)
+{
+    return addTargets(vector<Body>(1, target));
+}
+
+size_t ShardCluster::addTargets(const vector<Body> &targets)
+{
+    if (!running)
+        return INVALID_ID;
+
+    size_t first = target_count;
+    vector<vector<TargetRecord>> outbox(grid.count());
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        const float *pos = targets[i].pos_data();
+        outbox[grid.shardOf(pos[0], pos[1])].push_back(toRecord(targets[i], first + i));
+    }
+
+    // Only targets a worker actually holds are counted
+    for (size_t s = 0; s < workers.size(); s++)
+    {
+        if (outbox[s].empty())
+            continue;
+        if (!sendMessage(workers[s].fd, MSG_ADD_TARGETS, outbox[s].size(), 0, 0.0f,
+                         outbox[s].data(), outbox[s].size() * sizeof(TargetRecord)))
+        {
+            fail(s);
+            return INVALID_ID;
+        }
+        shard_targets[s] += outbox[s].size();
+        target_count += outbox[s].size();
+    }
+    return first;
+}
+
+bool ShardCluster::step()
+{
+    if (!running)
+        return false;
+
+    arena.reset();
+    merged = Span<const ClusterDetection>();
+    step_detections.assign(radars.size(), Span<const Detection>());
+
+    sim_time += dt;
+    for (auto &radar : radars)
+        radar.update(dt);
+
+    return advance() && scan();
+}
+
+bool ShardCluster::step(unsigned steps)
+{
+    for (unsigned i = 0; i < steps; i++)
+        if (!step())
+            return false;
+    return true;
+}
+
+bool ShardCluster::advance()
+{
+    const size_t shards = workers.size();
+
+    // Every worker steps in parallel, then the replies are collected in order
+    for (size_t s = 0; s < shards; s++)
+        if (!sendMessage(workers[s].fd, MSG_STEP, 0, 0, dt, nullptr, 0))
+            return fail(s);
+
+    Span<Span<TargetRecord>> leaving = arena.allocate<Span<TargetRecord>>(shards);
+    size_t total = 0;
+    for (size_t s = 0; s < shards; s++)
+    {
+        uint32_t kept;
+        if (!receive(workers[s].fd, arena, leaving[s], kept))
+            return fail(s);
+        shard_targets[s] = kept;
+        total += leaving[s].size();
+    }
+    if (total == 0)
+        return true;
+    migrations += total;
+
+    // Counting sort by new owner, so each owner gets one message
+    Span<uint32_t> offsets = arena.allocate<uint32_t>(shards + 1);
+    for (const auto &records : leaving)
+        for (const TargetRecord &r : records)
+            offsets[grid.shardOf(r.pos[0], r.pos[1]) + 1]++;
+    for (size_t s = 0; s < shards; s++)
+        offsets[s + 1] += offsets[s];
+
+    Span<TargetRecord> incoming = arena.allocate<TargetRecord>(total);
+    Span<uint32_t> fill = arena.allocate<uint32_t>(shards);
+    for (const auto &records : leaving)
+    {
+        for (const TargetRecord &r : records)
+        {
+            size_t dest = grid.shardOf(r.pos[0], r.pos[1]);
+            incoming[offsets[dest] + fill[dest]++] = r;
+        }
+    }
+
+    for (size_t s = 0; s < shards; s++)
+    {
+        size_t count = offsets[s + 1] - offsets[s];
+        if (count == 0)
+            continue;
+        if (!sendMessage(workers[s].fd, MSG_ADD_TARGETS, count, 0, 0.0f,
+                         incoming.data() + offsets[s], count * sizeof(TargetRecord)))
+            return fail(s);
+        shard_targets[s] += count;
+    }
+    return true;
+}
+
+bool ShardCluster::scan()
+{
+    const size_t shards = workers.size();
+    const size_t R = radars.size();
+
+    // Fan out: each worker gets the radars whose coverage overlaps its region
+    Span<uint32_t> lists = arena.allocate<uint32_t>(shards * R);
+    Span<uint32_t> list_sizes = arena.allocate<uint32_t>(shards);
+    for (size_t r = 0; r < R; r++)
+    {
+        vector<float> pos = radars[r].get_pos();
+        for (size_t s = 0; s < shards; s++)
+            if (grid.intersects(s, pos[0], pos[1], radars[r].get_max_range()))
+                lists[s * R + list_sizes[s]++] = r;
+    }
+
+    for (size_t s = 0; s < shards; s++)
+    {
+        if (list_sizes[s] == 0)
+            continue;
+        if (!sendMessage(workers[s].fd, MSG_SCAN, list_sizes[s], 0, sim_time,
+                         lists.data() + s * R, list_sizes[s] * sizeof(uint32_t)))
+            return fail(s);
+        scan_requests++;
+    }
+
+    Span<Span<Candidate>> replies = arena.allocate<Span<Candidate>>(shards);
+    size_t total = 0;
+    for (size_t s = 0; s < shards; s++)
+    {
+        uint32_t aux;
+        if (list_sizes[s] > 0 && !receive(workers[s].fd, arena, replies[s], aux))
+            return fail(s);
+        total += replies[s].size();
+    }
+
+    // Merge the shards' candidates per radar in target order, the order a single
+    // process scans in, so noise draws and duplicate suppression come out the same
+    Span<Candidate> candidates = arena.allocate<Candidate>(total);
+    size_t n = 0;
+    for (const auto &reply : replies)
+        for (const Candidate &c : reply)
+            candidates[n++] = c;
+    sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        if (a.radar != b.radar)
+            return a.radar < b.radar;
+        return a.target.id < b.target.id;
+    });
+
+    // Measurement noise and the detection roll stay on the coordinator's radars
+    size_t detections = 0;
+    Candidate *c = candidates.begin();
+    for (size_t r = 0; r < R; r++)
+    {
+        Candidate *first = c;
+        while (c != candidates.end() && c->radar == r)
+            c++;
+
+        Span<Detection> measured = arena.allocate<Detection>(c - first);
+        for (size_t i = 0; i < measured.size(); i++)
+            measured[i] = radars[r].scan(toBody(first[i].target), first[i].target.id, sim_time);
+
+        step_detections[r] = radars[r].record(measured, arena);
+        detections += step_detections[r].size();
+    }
+
+    Span<ClusterDetection> all = arena.allocate<ClusterDetection>(detections);
+    n = 0;
+    for (size_t r = 0; r < R; r++)
+        for (const Detection &det : step_detections[r])
+            all[n++] = {(uint32_t)r, det};
+    sort(all.begin(), all.end(), [](const ClusterDetection &a, const ClusterDetection &b) {
+        if (a.detection.timestamp != b.detection.timestamp)
+            return a.detection.timestamp < b.detection.timestamp;
+        if (a.radar != b.radar)
+            return a.radar < b.radar;
+        return a.detection.target_id < b.detection.target_id;
+    });
+    merged = Span<const ClusterDetection>(all.data(), all.size());
+    return true;
+}
+
+bool ShardCluster::gather(vector<Body> &targets)
+{
+    if (!running)
+        return false;
+
+    for (size_t s = 0; s < workers.size(); s++)
+        if (!sendMessage(workers[s].fd, MSG_GATHER, 0, 0, 0.0f, nullptr, 0))
+            return fail(s);
+
+    targets.assign(target_count, Body({0, 0}));
+    for (size_t s = 0; s < workers.size(); s++)
+    {
+        MessageHeader header;
+        if (!readAll(workers[s].fd, &header, sizeof(header)) || header.bytes != header.count * sizeof(TargetRecord))
+            return fail(s);
+
+        vector<TargetRecord> records(header.count);
+        if (header.bytes > 0 && !readAll(workers[s].fd, records.data(), header.bytes))
+            return fail(s);
+        for (const TargetRecord &r : records)
+            targets[r.id] = toBody(r);
+    }
+    return true;
+}
+
+void ShardCluster::serve(int fd, size_t shard, const ShardGrid &grid)
+{
+    vector<Radar> radars;
+    vector<Body> targets;
+    vector<uint32_t> ids;
+
+    vector<char> payload;
+    vector<TargetRecord> records;
+    vector<Candidate> candidates;
+
+    for (;;)
+    {
+        MessageHeader header;
+        if (!readAll(fd, &header, sizeof(header)))
+            _exit(0);
+        payload.resize(header.bytes);
+        if (header.bytes > 0 && !readAll(fd, payload.data(), header.bytes))
+            _exit(1);
+
+        bool ok = true;
+        switch (header.type)
+        {
+        case MSG_ADD_RADAR:
+        {
+            RadarRecord r;
+            memcpy(&r, payload.data(), sizeof(r));
+            radars.push_back(Radar({r.pos[0], r.pos[1]}, r.max_range, r.scan_interval, r.beam_width));
+            break;
+        }
+        case MSG_ADD_TARGETS:
+        {
+            records.resize(header.count);
+            memcpy(records.data(), payload.data(), header.bytes);
+            for (const TargetRecord &r : records)
+            {
+                targets.push_back(toBody(r));
+                ids.push_back(r.id);
+            }
+            break;
+        }
+        case MSG_STEP:
+        {
+            for (auto &radar : radars)
+                radar.update(header.value);
+
+            for (auto &target : targets)
+                target.update(header.value);
+
+            // Hand back the targets that left the region, compacting the rest in place
+            records.clear();
+            size_t kept = 0;
+            for (size_t i = 0; i < targets.size(); i++)
+            {
+                const float *pos = targets[i].pos_data();
+                if (grid.shardOf(pos[0], pos[1]) != shard)
+                {
+                    records.push_back(toRecord(targets[i], ids[i]));
+                    continue;
+                }
+                targets[kept] = targets[i];
+                ids[kept] = ids[i];
+                kept++;
+            }
+            targets.erase(targets.begin() + kept, targets.end());
+            ids.resize(kept);
+
+            ok = sendMessage(fd, MSG_STEP, records.size(), targets.size(), 0.0f,
+                             records.data(), records.size() * sizeof(TargetRecord));
+            break;
+        }
+        case MSG_SCAN:
+        {
+            vector<uint32_t> indices(header.count);
+            memcpy(indices.data(), payload.data(), header.bytes);
+
+            candidates.clear();
+            for (uint32_t r : indices)
+            {
+                const Radar &radar = radars[r];
+                for (size_t i = 0; i < targets.size(); i++)
+                {
+                    float time_before_end;
+                    if (!radar.findBeamCrossing(targets[i], time_before_end))
+                        continue;
+
+                    const float *pos = targets[i].pos_data();
+                    const float *vel = targets[i].vel_data();
+                    if (radar.distanceTo(pos[0] - vel[0] * time_before_end,
+                                         pos[1] - vel[1] * time_before_end) > radar.get_max_range())
+                        continue;
+                    candidates.push_back({r, toRecord(targets[i], ids[i])});
+                }
+            }
+            ok = sendMessage(fd, MSG_SCAN, candidates.size(), 0, 0.0f,
+                             candidates.data(), candidates.size() * sizeof(Candidate));
+            break;
+        }
+        case MSG_GATHER:
+        {
+            records.clear();
+            for (size_t i = 0; i < targets.size(); i++)
+                records.push_back(toRecord(targets[i], ids[i]));
+            ok = sendMessage(fd, MSG_GATHER, records.size(), 0, 0.0f,
+                             records.data(), records.size() * sizeof(TargetRecord));
+            break;
+        }
+        case MSG_SHUTDOWN:
+            _exit(0);
+        default:
+            _exit(1);
+        }
+
+        if (!ok)
+            _exit(1);
+    }
+}
@@ -0,0 +1,373 @@
+#include "SignalProcessor.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace
+{
+    const float SPEED_OF_LIGHT = 299792458.0f;
+    const size_t MAX_DWELL_DETECTIONS = 128;
+
+    // Probability of false alarm of an OS-CFAR with n training cells, rank k and scale alpha
+    double osPfa(size_t n, size_t k, double alpha)
+    {
+        double pfa = 1.0;
+        for (size_t i = 0; i < k; i++)
+            pfa *= (n - i) / (n - i + alpha);
+        return pfa;
+    }
+}
+
+SignalProcessor::SignalProcessor(const WaveformParams &waveform, unsigned seed)
+    : params(waveform),
+      generator(seed),
+      noise(0.0f, sqrt(0.5f)) // unit power complex noise
+{
+    // The Doppler FFT is radix-2
+    unsigned pulses = 2;
+    while (pulses < params.num_pulses)
+        pulses <<= 1;
+    params.num_pulses = pulses;
+
+    code = {1, 1, 1, 1, 1, -1, -1, 1, 1, -1, 1, -1, 1};
+
+    // CFAR needs training cells, and a pulse must hold the code plus one full
+    // CFAR window so at least one range bin can be tested
+    params.cfar_train = max(params.cfar_train, 1u);
+    params.num_range_bins = max<unsigned>(params.num_range_bins,
+                                          2 * (params.cfar_guard + params.cfar_train) + code.size() + 1);
+
+    const size_t M = params.num_pulses;
+    const size_t R = params.num_range_bins;
+
+    range_resolution = SPEED_OF_LIGHT / (2.0f * params.sample_rate);
+    wavelength = SPEED_OF_LIGHT / params.carrier_freq;
+    velocity_resolution = wavelength * params.prf / (2.0f * M);
+
+    window.resize(M);
+    for (size_t m = 0; m < M; m++)
+        window[m] = 0.5f - 0.5f * cos(2.0f * M_PI * m / M);
+
+    twiddle_re.resize(M / 2);
+    twiddle_im.resize(M / 2);
+    for (size_t k = 0; k < M / 2; k++)
+    {
+        twiddle_re[k] = cos(2.0 * M_PI * k / M);
+        twiddle_im[k] = -sin(2.0 * M_PI * k / M);
+    }
+
+    unsigned bits = 0;
+    while ((1u << bits) < M)
+        bits++;
+    bit_reverse.resize(M);
+    for (unsigned m = 0; m < M; m++)
+    {
+        unsigned r = 0;
+        for (unsigned b = 0; b < bits; b++)
+            r |= ((m >> b) & 1) << (bits - 1 - b);
+        bit_reverse[m] = r;
+    }
+
+    // Scale factors that give the requested Pfa in homogeneous noise
+    size_t n = 2 * params.cfar_train;
+    if (params.cfar == CfarType::CELL_AVERAGING)
+    {
+        cfar_alpha = n * (pow(params.pfa, -1.0 / n) - 1.0);
+        os_rank = 0;
+    }
+    else
+    {
+        os_rank = max<size_t>(1, 3 * n / 4);
+        double lo = 0, hi = 1e6;
+        for (int i = 0; i < 100; i++)
+        {
+            double mid = (lo + hi) / 2;
+            if (osPfa(n, os_rank, mid) > params.pfa)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        cfar_alpha = hi;
+    }
+
+    rx_re.resize(M * R);
+    rx_im.resize(M * R);
+    rd_re.resize(M * R);
+    rd_im.resize(M * R);
+    power.resize(M * R);
+    scratch.resize(n);
+}
+
+void SignalProcessor::reseed(unsigned seed)
+{
+    generator.seed(seed);
+    noise.reset();
+}
+
+Span<const Detection> SignalProcessor::scan(Radar &radar, const vector<Body> &targets, float current_time, FrameArena &arena)
+{
+    Span<Echo> echoes = arena.allocate<Echo>(targets.size());
+    size_t count = 0;
+
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        float time_before_end;
+        if (!radar.findBeamCrossing(targets[i], time_before_end))
+            continue;
+
+        const float *pos = targets[i].pos_data();
+        const float *vel = targets[i].vel_data();
+        float x = pos[0] - vel[0] * time_before_end;
+        float y = pos[1] - vel[1] * time_before_end;
+        float range = radar.distanceTo(x, y);
+        if (range > radar.get_max_range())
+            continue;
+
+        echoes[count++] = {range, radar.radialVelocity(x, y, vel[0], vel[1]), (int)i};
+    }
+
+    // Without monopulse the only bearing information is where the beam pointed
+    float azimuth = fmod(radar.getScanAngle() - radar.getSweepDeg() / 2 + 360.0f, 360.0f);
+    Span<const Detection> detections = dwell(Span<const Echo>(echoes.data(), count), azimuth, current_time, arena);
+    return radar.record(detections, arena);
+}
+
+Span<const Detection> SignalProcessor::dwell(Span<const Echo> echoes, float azimuth, float timestamp, FrameArena &arena)
+{
+    synthesize(echoes);
+    matchedFilter();
+    dopplerFft();
+
+    Span<Detection> out = arena.allocate<Detection>(MAX_DWELL_DETECTIONS);
+    size_t count = cfar(out, echoes, azimuth, timestamp);
+    return Span<const Detection>(out.data(), count);
+}
+
+void SignalProcessor::synthesize(Span<const Echo> echoes)
+{
+    const size_t M = params.num_pulses;
+    const size_t R = params.num_range_bins;
+
+    for (size_t i = 0; i < M * R; i++)
+    {
+        rx_re[i] = noise(generator);
+        rx_im[i] = noise(generator);
+    }
+
+    float amplitude = sqrt(pow(10.0f, params.snr_db / 10.0f));
+    for (const Echo &echo : echoes)
+    {
+        if (echo.range < 0 || echo.range >= getMaxRange())
+            continue;
+
+        // Two-way spreading loss, R^4 in power
+        float r = max(echo.range, range_resolution);
+        float a = amplitude * (params.reference_range / r) * (params.reference_range / r);
+
+        // Fractional delays are split between the two neighbouring samples
+        float delay = echo.range / range_resolution;
+        size_t d0 = (size_t)delay;
+        float frac = delay - d0;
+
+        // Receding targets have negative Doppler
+        float phase_step = -4.0f * M_PI * echo.radial_velocity / (wavelength * params.prf);
+        for (size_t m = 0; m < M; m++)
+        {
+            float c = a * cos(phase_step * m);
+            float s = a * sin(phase_step * m);
+            float *re = rx_re.data() + m * R;
+            float *im = rx_im.data() + m * R;
+            for (size_t k = 0; k < code.size(); k++)
+            {
+                size_t n = d0 + k;
+                if (n < R)
+                {
+                    re[n] += c * code[k] * (1 - frac);
+                    im[n] += s * code[k] * (1 - frac);
+                }
+                if (n + 1 < R)
+                {
+                    re[n + 1] += c * code[k] * frac;
+                    im[n + 1] += s * code[k] * frac;
+                }
+            }
+        }
+    }
+}
+
+void SignalProcessor::matchedFilter()
+{
+    const size_t M = params.num_pulses;
+    const size_t R = params.num_range_bins;
+
+    // Correlation with the (real) code, output bin n is the echo starting at sample n.
+    // The slow-time window is folded into the filter taps
+    for (size_t m = 0; m < M; m++)
+    {
+        const float *__restrict xr = rx_re.data() + m * R;
+        const float *__restrict xi = rx_im.data() + m * R;
+        float *__restrict yr = rd_re.data() + m * R;
+        float *__restrict yi = rd_im.data() + m * R;
+
+        fill(yr, yr + R, 0.0f);
+        fill(yi, yi + R, 0.0f);
+        for (size_t k = 0; k < code.size(); k++)
+        {
+            float tap = code[k] * window[m];
+            for (size_t n = 0; n + k < R; n++)
+            {
+                yr[n] += tap * xr[n + k];
+                yi[n] += tap * xi[n + k];
+            }
+        }
+    }
+}
+
+void SignalProcessor::dopplerFft()
+{
+    const size_t M = params.num_pulses;
+    const size_t R = params.num_range_bins;
+    float *re = rd_re.data();
+    float *im = rd_im.data();
+
+    for (size_t m = 0; m < M; m++)
+    {
+        size_t r = bit_reverse[m];
+        if (m < r)
+        {
+            swap_ranges(re + m * R, re + (m + 1) * R, re + r * R);
+            swap_ranges(im + m * R, im + (m + 1) * R, im + r * R);
+        }
+    }
+
+    // Radix-2 butterflies between whole pulse rows, every range bin at once
+    for (size_t len = 2; len <= M; len <<= 1)
+    {
+        size_t half = len / 2;
+        size_t stride = M / len;
+        for (size_t i = 0; i < M; i += len)
+        {
+            for (size_t j = 0; j < half; j++)
+            {
+                float wr = twiddle_re[j * stride];
+                float wi = twiddle_im[j * stride];
+                float *__restrict ar = re + (i + j) * R;
+                float *__restrict ai = im + (i + j) * R;
+                float *__restrict br = re + (i + j + half) * R;
+                float *__restrict bi = im + (i + j + half) * R;
+                for (size_t n = 0; n < R; n++)
+                {
+                    float tr = br[n] * wr - bi[n] * wi;
+                    float ti = br[n] * wi + bi[n] * wr;
+                    br[n] = ar[n] - tr;
+                    bi[n] = ai[n] - ti;
+                    ar[n] += tr;
+                    ai[n] += ti;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < M * R; i++)
+        power[i] = re[i] * re[i] + im[i] * im[i];
+}
+
+float SignalProcessor::cfarThreshold(const float *row, size_t n)
+{
+    const size_t G = params.cfar_guard;
+    const size_t T = params.cfar_train;
+
+    if (params.cfar == CfarType::CELL_AVERAGING)
+    {
+        float sum = 0;
+        for (size_t i = 1; i <= T; i++)
+            sum += row[n - G - i] + row[n + G + i];
+        return cfar_alpha * sum / (2 * T);
+    }
+
+    for (size_t i = 1; i <= T; i++)
+    {
+        scratch[2 * i - 2] = row[n - G - i];
+        scratch[2 * i - 1] = row[n + G + i];
+    }
+    nth_element(scratch.begin(), scratch.begin() + (os_rank - 1), scratch.end());
+    return cfar_alpha * scratch[os_rank - 1];
+}
+
+float SignalProcessor::velocityOfBin(float bin) const
+{
+    float doppler = bin * params.prf / params.num_pulses;
+    return -doppler * wavelength / 2;
+}
+
+size_t SignalProcessor::cfar(Span<Detection> out, Span<const Echo> echoes, float azimuth, float timestamp)
+{
+    const size_t M = params.num_pulses;
+    const size_t R = params.num_range_bins;
+    const size_t edge = params.cfar_guard + params.cfar_train;
+    size_t count = 0;
+
+    for (size_t m = 0; m < M && count < out.size(); m++)
+    {
+        const float *row = power.data() + m * R;
+        const float *prev = power.data() + ((m + M - 1) % M) * R;
+        const float *next = power.data() + ((m + 1) % M) * R;
+
+        // Cells need a full training window on both sides
+        for (size_t n = edge; n + edge < R && count < out.size(); n++)
+        {
+            float p = row[n];
+
+            // Only local maxima of the map are tested, one report per target
+            if (p <= row[n - 1] || p < row[n + 1] ||
+                p <= prev[n - 1] || p <= prev[n] || p <= prev[n + 1] ||
+                p < next[n - 1] || p < next[n] || p < next[n + 1])
+                continue;
+            if (p <= cfarThreshold(row, n))
+                continue;
+
+            // Parabolic interpolation in range and Doppler
+            float dr = 0, dd = 0;
+            float denom = row[n - 1] - 2 * p + row[n + 1];
+            if (denom < 0)
+                dr = 0.5f * (row[n - 1] - row[n + 1]) / denom;
+            denom = prev[n] - 2 * p + next[n];
+            if (denom < 0)
+                dd = 0.5f * (prev[n] - next[n]) / denom;
+
+            float bin = (m < M / 2 ? (float)m : (float)m - M) + dd;
+
+            Detection det;
+            det.detected = true;
+            det.distance = (n + dr) * range_resolution;
+            det.azimuth = azimuth;
+            det.radial_velocity = velocityOfBin(bin);
+            det.timestamp = timestamp;
+            det.lifespan = 1.0f;
+            det.target_id = -1;
+
+            // Associate with the closest echo, Doppler distance taken modulo the ambiguity
+            float best = 1.5f * 1.5f;
+            for (const Echo &echo : echoes)
+            {
+                float er = (echo.range - det.distance) / range_resolution;
+                float ev = fmod((echo.radial_velocity - det.radial_velocity) / velocity_resolution, (float)M);
+                if (ev > M / 2.0f)
+                    ev -= M;
+                if (ev < -(M / 2.0f))
+                    ev += M;
+                float d2 = er * er + ev * ev;
+                if (d2 < best)
+                {
+                    best = d2;
+                    det.target_id = echo.target_id;
+                }
+            }
+
+            out[count++] = det;
+        }
+    }
+    return count;
+}
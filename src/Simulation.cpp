@@ -0,0 +1,105 @@
+#include "Simulation.h"
+
+using namespace std;
+
+Simulation::Simulation(float dt)
+    : scan_mode(ScanMode::FULL),
+      dt(dt),
+      sim_time(0.0f)
+{
+}
+
+size_t Simulation::addRadar(const Radar &radar)
+{
+    radars.push_back(radar);
+    step_detections.resize(radars.size());
+    return radars.size() - 1;
+}
+
+size_t Simulation::addTarget(const Body &target)
+{
+    targets.push_back(target);
+    return targets.size() - 1;
+}
+
+void Simulation::step()
+{
+    arena.reset();
+    step_detections.resize(radars.size());
+
+    for (auto &target : targets)
+        target.update(dt);
+
+    sim_time += dt;
+    for (size_t i = 0; i < radars.size(); i++)
+    {
+        radars[i].update(dt);
+        if (i < signal_models.size() && signal_models[i])
+            step_detections[i] = signal_models[i]->scan(radars[i], targets, sim_time, arena);
+        else if (scan_mode == ScanMode::EVENT_DRIVEN)
+            step_detections[i] = scheduler.scan(i, radars[i], targets, sim_time, arena);
+        else
+            step_detections[i] = radars[i].scan(targets, sim_time, arena);
+    }
+}
+
+void Simulation::setScanMode(ScanMode mode)
+{
+    if (mode != scan_mode)
+        scheduler.clear();
+    scan_mode = mode;
+}
+
+void Simulation::enableSignalModel(size_t radar, const WaveformParams &params, unsigned seed)
+{
+    if (signal_models.size() <= radar)
+        signal_models.resize(radar + 1);
+    signal_models[radar].reset(new SignalProcessor(params, seed));
+}
+
+void Simulation::disableSignalModel(size_t radar)
+{
+    if (radar < signal_models.size())
+        signal_models[radar].reset();
+}
+
+void Simulation::manoeuvre(size_t target, const vector<float> &accel)
+{
+    targets[target].update(0.0f, accel);
+    scheduler.invalidate(target);
+}
+
+void Simulation::step(unsigned steps)
+{
+    for (unsigned i = 0; i < steps; i++)
+        step();
+}
+
+Checkpoint Simulation::checkpoint() const
+{
+    return Checkpoint::capture(radars, targets, sim_time, signal_models);
+}
+
+bool Simulation::restore(const Checkpoint &checkpoint)
+{
+    // A failed restore leaves the simulation as it was
+    if (!checkpoint.restore(radars, targets, sim_time, signal_models))
+        return false;
+    scheduler.clear();
+    step_detections.assign(radars.size(), Span<const Detection>());
+    return true;
+}
+
+bool Simulation::restore(const Checkpoint &checkpoint, unsigned seed)
+{
+    if (!restore(checkpoint))
+        return false;
+    for (size_t i = 0; i < radars.size(); i++)
+    {
+        radars[i].reseed(seed + i);
+        // Offset past the radars so a model never shares its radar's stream
+        if (signal_models[i])
+            signal_models[i]->reseed(seed + radars.size() + i);
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+#include "TrailStore.h"
+
+#include <algorithm>
+
+using namespace std;
+
+TrailStore::TrailStore(size_t length, unsigned decimation)
+    : length(max<size_t>(length, 2)),
+      decimation(max(decimation, 1u)),
+      calls(0),
+      target_count(0),
+      head(0)
+{
+}
+
+void TrailStore::configure(size_t length, unsigned decimation)
+{
+    this->length = max<size_t>(length, 2);
+    this->decimation = max(decimation, 1u);
+    clear();
+}
+
+void TrailStore::clear()
+{
+    target_count = 0;
+    head = 0;
+    calls = 0;
+    xs.clear();
+    ys.clear();
+}
+
+void TrailStore::reset(const vector<Body> &targets)
+{
+    target_count = targets.size();
+    head = 0;
+    calls = 0;
+    xs.resize(length * target_count);
+    ys.resize(length * target_count);
+
+    for (size_t t = 0; t < target_count; t++)
+    {
+        const float *pos = targets[t].pos_data();
+        for (size_t slot = 0; slot < length; slot++)
+        {
+            xs[slot * target_count + t] = pos[0];
+            ys[slot * target_count + t] = pos[1];
+        }
+    }
+}
+
+bool TrailStore::record(const vector<Body> &targets)
+{
+    if (++calls < decimation)
+        return false;
+    calls = 0;
+
+    head = (head + 1) % length;
+    float *x_row = xs.data() + head * target_count;
+    float *y_row = ys.data() + head * target_count;
+    for (size_t t = 0; t < target_count; t++)
+    {
+        const float *pos = targets[t].pos_data();
+        x_row[t] = pos[0];
+        y_row[t] = pos[1];
+    }
+    return true;
+}
@@ -1,6 +1,8 @@
 #include "Body.h"
 #include "Radar.h"
 #include "Renderer.h"
+#include "Checkpoint.h"
+#include "PlotPublisher.h"
 
 #include <SFML/Graphics.hpp>
 #include <iostream>
@@ -11,11 +13,29 @@
 #include <filesystem>
 #include <sstream>
 #include <cmath>
+#include <future>
+#include <chrono>
 
 using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
+    // Optional binary plot output, e.g. --publish udp:127.0.0.1:5000 or --publish unix:/tmp/plots.sock
+    // Only the last --publish is used
+    PlotPublisher publisher;
+    bool publishing = false;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (string(argv[i]) == "--publish")
+        {
+            if (!publisher.open(argv[i + 1]))
+                return 1;
+            publishing = true;
+        }
+    }
+    if (publishing)
+        publisher.start();
+
     // Window setup
     const float SCREEN_SIZE = 800.0f;
     const float WORLD_SIZE = 400.0f;
@@ -29,21 +49,43 @@ int main()
     vector<Body> targets;
     targets.push_back(Body({0, -25}));
 
+    // Latest detection of each target, what the renderer draws
     vector<Detection> detected(targets.size());
+    // Scan results only live for one step
+    FrameArena frame_arena;
 
     const vector<float> RADAR_POS = {0, 0};
     const float MAX_RANGE = 100.0f;
     const float SCAN_INTERVAL = 0.5f;
     const float BEAM_WIDTH = 50.0f;
 
-    Radar radar(RADAR_POS, MAX_RANGE, SCAN_INTERVAL, BEAM_WIDTH);
-    auto radar_pos = radar.get_pos();
+    vector<Radar> radars;
+    radars.push_back(Radar(RADAR_POS, MAX_RANGE, SCAN_INTERVAL, BEAM_WIDTH));
+    auto radar_pos = radars[0].get_pos();
     sf::Vector2f radarScreenPos = renderer.worldToScreen(radar_pos[0], radar_pos[1]);
 
-    cout << "Simulation started. Press SPACE to pause, R to reset, ESC to quit.\n";
+    const string CHECKPOINT_PATH = "data/checkpoint.bin";
+    future<bool> pending_save;
+    float pending_save_time = 0.0f;
+    // Reports the outcome of the background save once it has finished
+    auto report_save = [&](bool wait)
+    {
+        if (!pending_save.valid())
+            return;
+        if (!wait && pending_save.wait_for(chrono::seconds(0)) != future_status::ready)
+            return;
+        if (pending_save.get())
+            cout << "Checkpoint saved at t=" << pending_save_time << "s\n";
+        else
+            cerr << "\033[31m" << "Failed to save checkpoint " << CHECKPOINT_PATH << "\033[0m\n";
+    };
+
+    cout << "Simulation started. Press SPACE to pause, R to reset, S to save, L to load, ESC to quit.\n";
 
     while (renderer.isRunning())
     {
+        report_save(false);
+
         // Events
         sf::Event event;
         while (renderer.processEvents(event))
@@ -59,11 +101,45 @@ int main()
                 if (event.key.code == sf::Keyboard::R)
                 {
                     renderer.reset();
-                    radar.reset();
+                    radars[0].reset();
                     targets.clear();
                     targets.push_back(Body({0, 0}, {5, 5}));
                     targets.push_back(Body({10, 0}));
                     targets.push_back(Body({-25, -10}, {5, 5}, {1,1}));
+                    detected.assign(targets.size(), Detection());
+                }
+                if (event.key.code == sf::Keyboard::S)
+                {
+                    // Don't queue a second write behind one that is still running
+                    if (pending_save.valid() &&
+                        pending_save.wait_for(chrono::seconds(0)) != future_status::ready)
+                    {
+                        cerr << "Checkpoint save still in progress\n";
+                    }
+                    else
+                    {
+                        filesystem::create_directories("data");
+                        Checkpoint checkpoint = Checkpoint::capture(radars, targets, renderer.getSimTime());
+                        pending_save = checkpoint.saveAsync(CHECKPOINT_PATH);
+                        pending_save_time = renderer.getSimTime();
+                    }
+                }
+                if (event.key.code == sf::Keyboard::L)
+                {
+                    report_save(true);
+
+                    Checkpoint checkpoint;
+                    float sim_time;
+                    if (Checkpoint::load(CHECKPOINT_PATH, checkpoint) &&
+                        checkpoint.restore(radars, targets, sim_time))
+                    {
+                        renderer.setSimTime(sim_time);
+                        renderer.clear_trails();
+                        detected.assign(targets.size(), Detection());
+                        cout << "Checkpoint restored at t=" << sim_time << "s\n";
+                    }
+                    else
+                        cerr << "\033[31m" << "Failed to load checkpoint " << CHECKPOINT_PATH << "\033[0m\n";
                 }
             }
             if (event.type == sf::Event::MouseButtonPressed)
@@ -105,12 +181,15 @@ int main()
         // Update simulation
         if (!renderer.isPaused)
         {
+            frame_arena.reset();
+
             // Update all targets
             for (auto &target : targets)
             {
                 target.update(dt);
             }
-            radar.update(dt);
+            radars[0].update(dt);
+            renderer.record_trails(targets);
 
             float current_sim_time = renderer.advanceSimTime();
 
@@ -119,13 +198,15 @@ int main()
             // NEED TO FIX SCAN, the radar shouldnt get all targets and decide which ones fits in the cone,
             // the simulation gets a scan request from the radar and return only the targets within the cone, then
             // return a detection/body list to the radar
-            auto curr_detections = radar.scan(targets, current_sim_time);
+            Span<const Detection> curr_detections = radars[0].scan(targets, current_sim_time, frame_arena);
             cout << "Detected " << curr_detections.size() << " targets.\n";
+            renderer.add_returns(radars[0], curr_detections);
 
-            // Reset detection status
+            // Reset detection status, older detections fade out
             for(auto &d: detected)
             {
                 d.detected = false;
+                d.lifespan -= dt;
             }
 
             // Log detections
@@ -136,11 +217,12 @@ int main()
                         << ", Bearing=" << det.azimuth << "°"
                         << ", Velocity=" << det.radial_velocity << "m/s\n";
 
-                detected[det.target_id].detected = true;
+                detected[det.target_id] = det;
+                publisher.publish(0, det);
             }
         }
-        vector<Detection> curr_detections = radar.getDetections();
-        renderer.render(radar, targets, curr_detections);
+        renderer.render(radars[0], targets, detected);
     }
+    report_save(true);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "radarsim.h"
+#include "Simulation.h"
+
+#include <new>
+
+using namespace std;
+
+struct rs_scenario
+{
+    Simulation sim;
+
+    explicit rs_scenario(float dt) : sim(dt) {}
+};
+
+extern "C"
+{
+    rs_scenario *rs_scenario_create(float dt)
+    {
+        return new (nothrow) rs_scenario(dt);
+    }
+
+    void rs_scenario_destroy(rs_scenario *scenario)
+    {
+        delete scenario;
+    }
+
+    int rs_add_radar(rs_scenario *scenario, float x, float y, float max_range,
+                     float scan_interval, float beam_width, float noise_std)
+    {
+        if (!scenario)
+            return -1;
+        try
+        {
+            return scenario->sim.addRadar(Radar({x, y}, max_range, scan_interval, beam_width, noise_std));
+        }
+        catch (...)
+        {
+            return -1;
+        }
+    }
+
+    int rs_add_target(rs_scenario *scenario, float x, float y,
+                      float vx, float vy, float ax, float ay)
+    {
+        if (!scenario)
+            return -1;
+        try
+        {
+            return scenario->sim.addTarget(Body({x, y}, {vx, vy}, {ax, ay}));
+        }
+        catch (...)
+        {
+            return -1;
+        }
+    }
+
+    void rs_step(rs_scenario *scenario, unsigned steps)
+    {
+        if (scenario)
+            scenario->sim.step(steps);
+    }
+
+    float rs_sim_time(const rs_scenario *scenario)
+    {
+        return scenario ? scenario->sim.getSimTime() : 0.0f;
+    }
+
+    size_t rs_radar_count(const rs_scenario *scenario)
+    {
+        return scenario ? scenario->sim.getRadars().size() : 0;
+    }
+
+    float rs_scan_angle(const rs_scenario *scenario, size_t radar)
+    {
+        if (!scenario || radar >= scenario->sim.getRadars().size())
+            return 0.0f;
+        return scenario->sim.getRadars()[radar].getScanAngle();
+    }
+
+    rs_target_view rs_targets(const rs_scenario *scenario)
+    {
+        rs_target_view view = {};
+        view.stride = sizeof(Body);
+        if (!scenario || scenario->sim.getTargets().empty())
+            return view;
+
+        const Body &first = scenario->sim.getTargets().front();
+        view.pos = first.pos_data();
+        view.vel = first.vel_data();
+        view.accel = first.accel_data();
+        view.count = scenario->sim.getTargets().size();
+        return view;
+    }
+
+    int rs_detections(const rs_scenario *scenario, size_t radar, rs_detection_view *view)
+    {
+        if (!scenario || !view || radar >= scenario->sim.getRadars().size())
+            return -1;
+
+        const vector<Detection> &detections = scenario->sim.getRadars()[radar].getDetections();
+        *view = rs_detection_view();
+        view->stride = sizeof(Detection);
+        view->count = detections.size();
+        if (detections.empty())
+            return 0;
+
+        const Detection &first = detections.front();
+        view->detected = &first.detected;
+        view->distance = &first.distance;
+        view->azimuth = &first.azimuth;
+        view->radial_velocity = &first.radial_velocity;
+        view->timestamp = &first.timestamp;
+        view->target_id = &first.target_id;
+        return 0;
+    }
+}
@@ -0,0 +1,93 @@
+#include "FrameArena.h"
+#include "Simulation.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Counting allocator: every global operator new in this process goes through here
+static std::atomic<size_t> allocation_count(0);
+
+void *operator new(size_t size)
+{
+    allocation_count++;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+int main()
+{
+    std::cout << "\e[1;93m";
+    std::cout << "Frame Arena Test" << std::endl;
+    std::cout << "\033[0m";
+
+    FrameArena arena(64);
+    Span<float> a = arena.allocate<float>(4);
+    Span<double> b = arena.allocate<double>(3);
+    check("Allocations have the requested size", a.size() == 4 && b.size() == 3);
+    check("Allocations are aligned", reinterpret_cast<uintptr_t>(b.data()) % alignof(double) == 0);
+
+    // Past the capacity, then the next reset grows to fit
+    Span<Detection> big = arena.allocate<Detection>(100);
+    check("Overflow allocation succeeds", big.size() == 100);
+    arena.reset();
+    check("Arena grows to the high-water mark", arena.capacity() >= 100 * sizeof(Detection));
+
+    size_t before = allocation_count;
+    arena.allocate<float>(4);
+    arena.allocate<double>(3);
+    arena.allocate<Detection>(100);
+    arena.reset();
+    check("Steady-state arena use does not allocate", allocation_count == before);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Zero Allocation Step Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Simulation sim(0.05f);
+    sim.addRadar(Radar({0, 0}, 200.0f, 0.5f, 360.0f));
+    sim.addRadar(Radar({30, 30}, 80.0f, 1.0f, 45.0f));
+    for (int i = 0; i < 50; i++)
+        sim.addTarget(Body({(float)(i % 10) * 8 - 40, (float)(i / 10) * 8 - 20},
+                           {(float)(i % 3) - 1, (float)(i % 5) - 2}));
+
+    // Warm-up lets the detection lists and the arena reach their working size
+    sim.step(400);
+
+    size_t detections = 0;
+    before = allocation_count;
+    for (int s = 0; s < 200; s++)
+    {
+        sim.step();
+        for (size_t r = 0; r < sim.getRadars().size(); r++)
+            for (const Detection &det : sim.getStepDetections(r))
+                detections += det.detected;
+    }
+    size_t allocations = allocation_count - before;
+
+    check("Steps produced detections", detections > 0);
+    std::cout << "  " << allocations << " allocations over 200 steps" << std::endl;
+    check("Steady-state steps do not allocate", allocations == 0);
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "radarsim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void check(const char *name, int condition)
+{
+    if (!condition)
+    {
+        fprintf(stderr, "\033[31m[X]\033[0m %s\n", name);
+        exit(1);
+    }
+    printf("\033[32m[V]\033[0m %s\n", name);
+}
+
+static const float *field_at(const float *field, size_t stride, size_t n)
+{
+    return (const float *)((const char *)field + n * stride);
+}
+
+static const int *id_at(const int *field, size_t stride, size_t n)
+{
+    return (const int *)((const char *)field + n * stride);
+}
+
+int main(void)
+{
+    printf("\033[1;93mC API Test\n\033[0m");
+
+    rs_scenario *scenario = rs_scenario_create(0.1f);
+    check("Scenario created", scenario != NULL);
+
+    check("Radar added", rs_add_radar(scenario, 0, 0, 100.0f, 0.5f, 360.0f, 0.0f) == 0);
+    check("First target added", rs_add_target(scenario, 10, 0, 1, 0, 0, 0) == 0);
+    check("Second target added", rs_add_target(scenario, 0, -20, 0, 2, 0, 1) == 1);
+    check("Radar count", rs_radar_count(scenario) == 1);
+
+    rs_step(scenario, 10);
+    check("Sim time advanced", fabsf(rs_sim_time(scenario) - 1.0f) < 1e-4f);
+
+    rs_target_view targets = rs_targets(scenario);
+    check("Target count", targets.count == 2);
+
+    const float *pos0 = field_at(targets.pos, targets.stride, 0);
+    const float *pos1 = field_at(targets.pos, targets.stride, 1);
+    const float *vel1 = field_at(targets.vel, targets.stride, 1);
+    check("Target 0 moved", fabsf(pos0[0] - 11.0f) < 1e-3f && fabsf(pos0[1]) < 1e-3f);
+    check("Target 1 accelerated", fabsf(vel1[1] - 3.0f) < 1e-3f && pos1[1] > -18.0f);
+
+    /* Stepping updates the same storage the view points at */
+    rs_step(scenario, 1);
+    rs_target_view again = rs_targets(scenario);
+    check("View is zero-copy", again.pos == targets.pos && pos0[0] > 11.0f);
+
+    rs_detection_view detections;
+    check("Detection view", rs_detections(scenario, 0, &detections) == 0);
+    check("Detections produced", detections.count > 0 && detections.stride > 0);
+
+    /* Target 0 runs out from 10 m to 11 m, target 1 closes in from 20 m, and the radar has no range noise */
+    int plausible = 1;
+    for (size_t n = 0; n < detections.count; n++)
+    {
+        const int *id = id_at(detections.target_id, detections.stride, n);
+        float distance = *field_at(detections.distance, detections.stride, n);
+        if (*id == 0)
+            plausible = plausible && distance > 9.5f && distance < 11.5f;
+        else if (*id == 1)
+            plausible = plausible && distance > 15.0f && distance < 20.5f;
+        else
+            plausible = 0;
+    }
+    check("Detections read through the stride", plausible);
+    check("Detection view rejects bad radar", rs_detections(scenario, 3, &detections) == -1);
+
+    rs_scenario_destroy(scenario);
+
+    printf("\033[1;92mAll tests were successful!\n\033[0m");
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include "Checkpoint.h"
+#include "Simulation.h"
+#include "Radar.h"
+#include "Body.h"
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+// Steps the scenario and returns a trace of noisy single-target scans,
+// which depends on both the kinematics and the radar RNG state
+std::vector<float> run(std::vector<Radar> &radars, std::vector<Body> &targets, float &sim_time, int steps)
+{
+    const float dt = 0.05f;
+    std::vector<float> trace;
+    for (int s = 0; s < steps; s++)
+    {
+        for (auto &target : targets)
+            target.update(dt);
+        for (auto &radar : radars)
+            radar.update(dt);
+        sim_time += dt;
+
+        for (auto &radar : radars)
+            for (size_t i = 0; i < targets.size(); i++)
+            {
+                Detection det = radar.scan(targets[i], i, sim_time);
+                trace.push_back(det.detected ? det.distance : -1.0f);
+            }
+    }
+    for (auto &radar : radars)
+        trace.push_back(radar.getScanAngle());
+    for (auto &target : targets)
+    {
+        trace.push_back(target.get_pos()[0]);
+        trace.push_back(target.get_pos()[1]);
+    }
+    return trace;
+}
+
+int main()
+{
+    std::vector<Radar> radars;
+    radars.push_back(Radar({0, 0}, 100.0f, 0.5f, 360.0f));
+    radars.push_back(Radar({20, -10}, 60.0f, 1.0f, 360.0f));
+
+    std::vector<Body> targets;
+    targets.push_back(Body({0, -25}, {1, 2}));
+    targets.push_back(Body({10, 5}, {-3, 0}, {0.5f, 0.5f}));
+    float sim_time = 0.0f;
+
+    std::cout << "\e[1;93m";
+    std::cout << "Checkpoint Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // Warm-up shared by every variant
+    run(radars, targets, sim_time, 40);
+    Checkpoint checkpoint = Checkpoint::capture(radars, targets, sim_time);
+    check("Checkpoint captured", !checkpoint.empty());
+
+    // Fork two variants from the same checkpoint, they must evolve identically
+    std::vector<Radar> radars_a, radars_b;
+    std::vector<Body> targets_a, targets_b;
+    float time_a = 0, time_b = 0;
+    check("Fork A restored", checkpoint.restore(radars_a, targets_a, time_a));
+    check("Fork B restored", checkpoint.restore(radars_b, targets_b, time_b));
+    check("Fork restores sim clock", time_a == sim_time && time_b == sim_time);
+
+    std::vector<float> trace_a = run(radars_a, targets_a, time_a, 60);
+    std::vector<float> trace_b = run(radars_b, targets_b, time_b, 60);
+    std::vector<float> trace = run(radars, targets, sim_time, 60);
+    check("Forks are deterministic", trace_a == trace_b);
+    check("Forks continue the original run", trace_a == trace);
+
+    // Reseeded forks share the warm-up but draw their own noise from then on
+    auto sim_trace = [](Simulation &sim, int steps)
+    {
+        std::vector<float> distances;
+        for (int s = 0; s < steps; s++)
+        {
+            sim.step();
+            for (const Detection &d : sim.getStepDetections(0))
+                distances.push_back(d.distance);
+        }
+        return distances;
+    };
+    Simulation warm(0.05f);
+    warm.addRadar(Radar({0, 0}, 100.0f, 0.5f, 360.0f));
+    for (int i = 0; i < 8; i++)
+        warm.addTarget(Body({10.0f * i - 40, 30}, {1, -1}));
+    sim_trace(warm, 20);
+    Checkpoint warm_checkpoint = warm.checkpoint();
+
+    Simulation fork_1(0.05f), fork_2(0.05f), fork_same(0.05f), fork_repeat(0.05f);
+    check("Seeded forks restored", fork_1.restore(warm_checkpoint, 1) && fork_2.restore(warm_checkpoint, 2) &&
+                                       fork_repeat.restore(warm_checkpoint, 1) && fork_same.restore(warm_checkpoint));
+    std::vector<float> trace_1 = sim_trace(fork_1, 60);
+    std::vector<float> trace_2 = sim_trace(fork_2, 60);
+    check("Forks with different seeds diverge", !trace_1.empty() && trace_1 != trace_2);
+    check("Forks with the same seed agree", trace_1 == sim_trace(fork_repeat, 60));
+    check("Unseeded fork continues the original run", sim_trace(fork_same, 60) == sim_trace(warm, 60));
+
+    // Signal-model radars come back with their waveform and receiver noise state
+    Simulation signal(0.05f);
+    signal.addRadar(Radar({0, 0}, 150.0f, 1.0f, 10.0f));
+    signal.addRadar(Radar({20, 0}, 100.0f, 0.5f, 360.0f));
+    signal.addTarget(Body({50, 50}, {-3, 1}));
+    signal.addTarget(Body({-30, 40}, {2, 0}));
+    WaveformParams waveform;
+    waveform.snr_db = 0.0f;
+    waveform.cfar = CfarType::ORDERED_STATISTIC;
+    signal.enableSignalModel(0, waveform, 3);
+    sim_trace(signal, 15);
+    Checkpoint signal_checkpoint = signal.checkpoint();
+
+    Simulation signal_fork(0.05f);
+    check("Signal model checkpoint restores", signal_fork.restore(signal_checkpoint));
+    std::vector<float> signal_trace = sim_trace(signal, 40);
+    check("Restored signal model continues the original run",
+          !signal_trace.empty() && sim_trace(signal_fork, 40) == signal_trace);
+
+    Simulation signal_reseeded(0.05f);
+    signal_reseeded.restore(signal_checkpoint, 9);
+    Simulation signal_again(0.05f);
+    signal_again.restore(signal_checkpoint);
+    check("Reseeded signal model diverges", sim_trace(signal_reseeded, 40) != sim_trace(signal_again, 40));
+
+    std::vector<Radar> radars_s;
+    std::vector<Body> targets_s;
+    float time_s = 0;
+    check("Plain restore refuses to drop signal models", !signal_checkpoint.restore(radars_s, targets_s, time_s));
+
+    // Round trip through disk
+    const std::string path = "test_checkpoint.bin";
+    check("Async save", checkpoint.saveAsync(path).get());
+
+    Checkpoint loaded;
+    check("Load", Checkpoint::load(path, loaded));
+    check("Loaded size matches", loaded.size() == checkpoint.size());
+
+    std::vector<Radar> radars_c;
+    std::vector<Body> targets_c;
+    float time_c = 0;
+    check("Loaded checkpoint restores", loaded.restore(radars_c, targets_c, time_c));
+    check("Loaded run matches", run(radars_c, targets_c, time_c, 60) == trace_a);
+    std::remove(path.c_str());
+
+    Checkpoint missing;
+    check("Missing file is rejected", !Checkpoint::load("does_not_exist.bin", missing));
+    check("Empty checkpoint does not restore", !missing.restore(radars_c, targets_c, time_c));
+
+    // Damaged files must fail to restore, not throw or allocate what they claim
+    std::vector<Radar> lone = {Radar({0, 0}, 100.0f)};
+    std::vector<Body> none;
+    Checkpoint::capture(lone, none, 0.0f).save(path);
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    auto restores = [&](const std::vector<char> &contents)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size());
+        out.close();
+        Checkpoint damaged;
+        std::vector<Radar> radars_d;
+        std::vector<Body> targets_d;
+        float time_d = 0;
+        return Checkpoint::load(path, damaged) && damaged.restore(radars_d, targets_d, time_d);
+    };
+
+    bool truncated_fail = true;
+    for (size_t n = 1; n < bytes.size(); n++)
+        truncated_fail = truncated_fail && !restores(std::vector<char>(bytes.begin(), bytes.begin() + n));
+    check("Truncated checkpoints are rejected", truncated_fail && restores(bytes));
+
+    // Header, clock, no targets, one radar's position and 11 parameters, then its detection count
+    const size_t detection_count_offset = 4 + 4 + 4 + 4 + 4 + (4 + 2 * sizeof(float)) + 11 * sizeof(float);
+    std::vector<char> corrupt = bytes;
+    const uint32_t huge = 0xFFFFFFFFu;
+    std::memcpy(corrupt.data() + detection_count_offset, &huge, sizeof(huge));
+    check("Corrupt detection count is rejected", !restores(corrupt));
+
+    // A simulation keeps its state, and stays steppable, when the checkpoint is damaged
+    Simulation sim(0.05f);
+    sim.addRadar(Radar({0, 0}, 100.0f));
+    sim.addTarget(Body({30, 0}, {1, 0}));
+    sim.step(20);
+    restores(corrupt);
+    Checkpoint damaged;
+    Checkpoint::load(path, damaged);
+    float before = sim.getSimTime();
+    bool kept = !sim.restore(damaged) && sim.getSimTime() == before && sim.getRadars().size() == 1;
+    Span<const Detection> last = sim.getStepDetections(0);
+    sim.step();
+    check("Failed restore leaves the simulation usable",
+          kept && last.size() <= 1 && sim.getStepDetections(0).size() <= 1);
+    std::remove(path.c_str());
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
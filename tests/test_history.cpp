@@ -0,0 +1,236 @@
+#include "DetectionHistory.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+// Detections of a radar over [0, steps * dt), in unsorted batches of one step each
+std::vector<std::vector<Detection>> make_batches(size_t steps, size_t per_step, float dt, unsigned seed)
+{
+    std::default_random_engine rng(seed);
+    std::uniform_real_distribution<float> range(0.0f, 150.0f);
+    std::uniform_real_distribution<float> azimuth(-10.0f, 370.0f);
+    std::uniform_real_distribution<float> velocity(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> offset(0.0f, 1.0f);
+    std::uniform_int_distribution<int> target(0, 5000);
+
+    std::vector<std::vector<Detection>> batches(steps);
+    for (size_t s = 0; s < steps; s++)
+        for (size_t i = 0; i < per_step; i++)
+        {
+            Detection det;
+            det.detected = true;
+            det.distance = range(rng);
+            det.azimuth = azimuth(rng);
+            det.radial_velocity = velocity(rng);
+            det.timestamp = (s + offset(rng)) * dt;
+            det.target_id = target(rng);
+            det.lifespan = 1.0f;
+            batches[s].push_back(det);
+        }
+    return batches;
+}
+
+float wrap360(float deg)
+{
+    deg = std::fmod(deg, 360.0f);
+    return deg < 0 ? deg + 360.0f : deg;
+}
+
+// Decoded and original detections, both in time order, agree to half a step
+bool within_resolution(const std::vector<Detection> &decoded, const std::vector<Detection> &original,
+                       const HistoryResolution &res)
+{
+    if (decoded.size() != original.size())
+        return false;
+    for (size_t i = 0; i < decoded.size(); i++)
+    {
+        const Detection &a = decoded[i];
+        const Detection &b = original[i];
+        float azimuth_error = std::fabs(a.azimuth - wrap360(b.azimuth));
+        azimuth_error = std::min(azimuth_error, 360.0f - azimuth_error);
+        if (a.target_id != b.target_id ||
+            std::fabs(a.timestamp - b.timestamp) > res.time * 0.5f + 1e-4f ||
+            std::fabs(a.distance - b.distance) > res.range * 0.5f + 1e-4f ||
+            azimuth_error > res.azimuth * 0.5f + 1e-3f ||
+            std::fabs(a.radial_velocity - b.radial_velocity) > res.velocity * 0.5f + 1e-4f)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    std::cout << "\e[1;93m";
+    std::cout << "Round Trip Test" << std::endl;
+    std::cout << "\033[0m";
+
+    const float dt = 0.02f;
+    HistoryResolution res;
+    DetectionHistory history;
+    size_t first = history.addRadar(res);
+    size_t second = history.addRadar(res);
+
+    // 1000 detections is not a multiple of the block size, so the last ones stay in the open block
+    std::vector<std::vector<Detection>> batches = make_batches(200, 5, dt, 1);
+    std::vector<Detection> original;
+    for (std::vector<Detection> &batch : batches)
+    {
+        history.append(first, batch);
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const Detection &a, const Detection &b) { return a.timestamp < b.timestamp; });
+        original.insert(original.end(), batch.begin(), batch.end());
+    }
+    std::vector<Detection> other = make_batches(1, 3, dt, 2)[0];
+    history.append(second, other);
+
+    check("Detections are counted per radar",
+          history.size(first) == 1000 && history.size(second) == 3 && history.size() == 1003);
+
+    std::vector<Detection> decoded;
+    size_t count = history.query(first, 0.0f, 200 * dt, decoded);
+    check("Full window returns every detection", count == 1000 && decoded.size() == 1000);
+    check("Round trip is within half a resolution step", within_resolution(decoded, original, res));
+
+    bool ordered = true;
+    for (size_t i = 1; i < decoded.size(); i++)
+        ordered = ordered && decoded[i - 1].timestamp <= decoded[i].timestamp;
+    check("Query results are in time order", ordered);
+
+    std::vector<Detection> second_decoded;
+    history.query(second, 0.0f, 200 * dt, second_decoded);
+    check("Radars are kept apart", second_decoded.size() == 3);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Time Window Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // Windows inside a block, across block boundaries and into the open block
+    bool windows = true;
+    for (float t0 : {0.0f, 0.5f, 1.3f, 2.7f, 3.9f})
+    {
+        float t1 = t0 + 0.45f;
+        size_t expected = 0;
+        for (const Detection &d : decoded)
+            expected += d.timestamp >= t0 && d.timestamp <= t1;
+        std::vector<Detection> window;
+        size_t found = history.query(first, t0, t1, window);
+        bool inside = true;
+        for (const Detection &d : window)
+            inside = inside && d.timestamp >= t0 && d.timestamp <= t1;
+        windows = windows && found == expected && window.size() == expected && inside;
+    }
+    check("Time windows return exactly the detections inside them", windows);
+
+    std::vector<Detection> empty;
+    check("Windows outside the history are empty",
+          history.query(first, 10.0f, 20.0f, empty) == 0 && history.query(first, -5.0f, -1.0f, empty) == 0);
+
+    history.flush();
+    std::vector<Detection> flushed;
+    history.query(first, 0.0f, 200 * dt, flushed);
+    check("Flushed blocks decode the same", within_resolution(flushed, original, res) && history.size() == 1003);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Long Run Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // A day of a busy radar: 10 plots per second
+    DetectionHistory day;
+    size_t radar = day.addRadar();
+    std::default_random_engine rng(5);
+    std::uniform_real_distribution<float> range(0.0f, 150.0f);
+    std::uniform_real_distribution<float> azimuth(0.0f, 360.0f);
+    std::uniform_real_distribution<float> velocity(-20.0f, 20.0f);
+    std::vector<Detection> second_of_plots(10);
+    for (int s = 0; s < 86400; s++)
+    {
+        for (size_t i = 0; i < second_of_plots.size(); i++)
+        {
+            Detection &det = second_of_plots[i];
+            det.distance = range(rng);
+            det.azimuth = azimuth(rng);
+            det.radial_velocity = velocity(rng);
+            det.timestamp = s + i * 0.1f;
+            det.target_id = i * 37;
+        }
+        day.append(radar, second_of_plots);
+    }
+    double per_detection = (double)day.bytes() / day.size();
+    std::cout << "  " << day.size() << " detections in " << day.bytes() / 1024 << " KiB, " << per_detection
+              << " bytes each (" << sizeof(Detection) << " unpacked)" << std::endl;
+    check("Detections take well under half their unpacked size", per_detection < sizeof(Detection) / 2.0);
+
+    std::vector<Detection> hour;
+    auto t0 = std::chrono::steady_clock::now();
+    size_t hour_count = day.query(radar, 43200.0f, 46800.0f, hour);
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << "  " << hour_count << " detections of one hour in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+    // Float timestamps near noon are exact to a few ms, the window ends may land either side
+    check("Hour window finds an hour of detections", hour_count >= 35990 && hour_count <= 36010);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Simulation Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Simulation sim(dt);
+    Radar noisy({0, 0}, 120.0f, 0.5f, 8.0f, 1.0f);
+    sim.addRadar(noisy);
+    sim.addRadar(Radar({40, 20}, 100.0f, 0.25f, 10.0f, 0.0f));
+    std::uniform_real_distribution<float> position(-140.0f, 140.0f);
+    std::uniform_real_distribution<float> speed(-10.0f, 10.0f);
+    for (int i = 0; i < 300; i++)
+        sim.addTarget(Body({position(rng), position(rng)}, {speed(rng), speed(rng)}));
+
+    DetectionHistory recorded;
+    for (const Radar &r : sim.getRadars())
+        recorded.addRadar(HistoryResolution::forRadar(r));
+
+    HistoryResolution noisy_res = HistoryResolution::forRadar(sim.getRadars()[0]);
+    check("Resolution follows the radar's noise",
+          std::fabs(noisy_res.range - 0.125f) < 1e-6f && std::fabs(noisy_res.azimuth - 0.0625f) < 1e-6f &&
+              HistoryResolution::forRadar(sim.getRadars()[1]).range == HistoryResolution().range);
+
+    std::vector<std::vector<Detection>> expected(sim.getRadars().size());
+    for (int s = 0; s < 1000; s++)
+    {
+        sim.step();
+        for (size_t r = 0; r < sim.getRadars().size(); r++)
+        {
+            Span<const Detection> step = sim.getStepDetections(r);
+            recorded.append(r, step);
+            expected[r].insert(expected[r].end(), step.begin(), step.end());
+        }
+    }
+
+    bool matches = true;
+    for (size_t r = 0; r < expected.size(); r++)
+    {
+        std::stable_sort(expected[r].begin(), expected[r].end(),
+                         [](const Detection &a, const Detection &b) { return a.timestamp < b.timestamp; });
+        std::vector<Detection> out;
+        recorded.query(r, 0.0f, sim.getSimTime() + 1.0f, out);
+        matches = matches && !expected[r].empty() &&
+                  within_resolution(out, expected[r], HistoryResolution::forRadar(sim.getRadars()[r]));
+    }
+    std::cout << "  " << recorded.size() << " detections in " << recorded.bytes() << " bytes" << std::endl;
+    check("Simulation detections round trip", matches);
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "MetricsEngine.h"
+#include "Simulation.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+bool near(double a, double b, double tolerance = 1e-9)
+{
+    return std::fabs(a - b) <= tolerance;
+}
+
+// Sparse scenario, so few detections are suppressed as duplicates of other targets
+Simulation scenario(size_t radar_count, float detection_prob, float noise)
+{
+    Simulation sim(0.02f);
+    for (size_t r = 0; r < radar_count; r++)
+    {
+        Radar radar({r * 40.0f, 0}, 150.0f, 0.5f, 10.0f);
+        radar.setDetectionProb(detection_prob);
+        radar.setNoise(noise, noise / 2, noise / 4);
+        sim.addRadar(radar);
+    }
+
+    std::default_random_engine rng(5);
+    std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+    std::uniform_real_distribution<float> velocity(-6.0f, 6.0f);
+    for (int i = 0; i < 200; i++)
+        sim.addTarget(Body({position(rng), position(rng)}, {velocity(rng), velocity(rng)}));
+    return sim;
+}
+
+int main()
+{
+    std::cout << "\e[1;93m";
+    std::cout << "Error Statistics Test" << std::endl;
+    std::cout << "\033[0m";
+
+    ErrorStats stats;
+    for (double x : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0})
+        stats.add(x);
+    check("Running mean", near(stats.mean, 5.0));
+    check("Running sample deviation", near(stats.variance(), 32.0 / 7));
+    check("RMS and worst case", near(stats.rms(), std::sqrt(29.0)) && stats.max_abs == 9.0);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Detection Accuracy Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // Without noise the measurement equals the truth at the detection time, so
+    // the join must come out with (nearly) zero error
+    Simulation exact = scenario(1, 1.0f, 0.0f);
+    MetricsEngine exact_metrics;
+    for (int s = 0; s < 200; s++)
+    {
+        exact.step();
+        exact_metrics.evaluate(exact);
+    }
+    const RadarMetrics &e = exact_metrics.getRadar(0);
+    check("Noise-free detections were joined", e.range.count > 50);
+    check("Truth is taken at the detection timestamp",
+          e.range.max_abs < 1e-3 && e.bearing.max_abs < 1e-2 && e.radial_velocity.max_abs < 1e-3);
+
+    uint64_t passes = 0, hits = 0;
+    for (size_t b = 0; b < e.opportunities.size(); b++)
+    {
+        passes += e.opportunities[b];
+        hits += e.hits[b];
+    }
+    std::cout << "  " << hits << "/" << passes << " beam passes" << std::endl;
+    // The misses are plots suppressed next to another target's
+    check("Certain detection gives a Pd of about one per pass", passes > 50 && hits >= 0.95 * passes);
+
+    // The radar's noise draws are 0.5 * the configured std. Repeat looks in one
+    // pass are only kept when they land away from the first one, which widens
+    // the spread of what gets reported a little
+    Simulation noisy = scenario(1, 0.7f, 2.0f);
+    MetricsEngine noisy_metrics;
+    for (int s = 0; s < 1000; s++)
+    {
+        noisy.step();
+        noisy_metrics.evaluate(noisy);
+    }
+    const RadarMetrics &n = noisy_metrics.getRadar(0);
+    std::cout << "  range std " << n.range.stddev() << ", bearing std " << n.bearing.stddev()
+              << ", velocity std " << n.radial_velocity.stddev() << std::endl;
+    check("Range error statistics", std::fabs(n.range.mean) < 0.1 && n.range.stddev() > 0.95 && n.range.stddev() < 1.2);
+    check("Bearing error statistics", std::fabs(n.bearing.mean) < 0.05 && n.bearing.stddev() > 0.47 && n.bearing.stddev() < 0.6);
+    check("Radial velocity error statistics", std::fabs(n.radial_velocity.stddev() - 0.25) < 0.03);
+
+    passes = 0;
+    hits = 0;
+    for (size_t b = 0; b < n.opportunities.size(); b++)
+    {
+        passes += n.opportunities[b];
+        hits += n.hits[b];
+    }
+    double pd = (double)hits / passes;
+    std::cout << "  Pd " << pd << " over " << passes << " beam passes" << std::endl;
+    // Each pass gives the 0.7 roll about three looks
+    check("Pd per pass grows with the looks in the beam", pd > 0.85 && pd < 1.0);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Parallel Evaluation Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Simulation multi = scenario(6, 0.9f, 1.0f);
+    MetricsConfig serial_config;
+    serial_config.threads = 1;
+    MetricsEngine serial(serial_config);
+    MetricsEngine parallel;
+    for (int s = 0; s < 200; s++)
+    {
+        multi.step();
+        serial.evaluate(multi);
+        parallel.evaluate(multi);
+    }
+    bool same = serial.getRadarCount() == 6 && parallel.getRadarCount() == 6;
+    for (size_t r = 0; r < 6 && same; r++)
+    {
+        const RadarMetrics &a = serial.getRadar(r);
+        const RadarMetrics &b = parallel.getRadar(r);
+        same = a.range.count == b.range.count && a.range.m2 == b.range.m2 &&
+               a.bearing.mean == b.bearing.mean && a.opportunities == b.opportunities && a.hits == b.hits;
+    }
+    check("Threads give the same statistics as one", same);
+
+    // Fewer detection spans than radars is refused before anything is read
+    MetricsEngine short_input;
+    std::vector<Span<const Detection>> too_few(multi.getRadars().size() - 1);
+    check("Mismatched detection spans are rejected",
+          !short_input.evaluate(multi.getRadars(), multi.getTargets(), too_few, multi.getSimTime()) &&
+              short_input.getRadarCount() == 0 && short_input.evaluate(multi));
+
+    std::cout << "\e[1;93m";
+    std::cout << "OSPA / GOSPA Test" << std::endl;
+    std::cout << "\033[0m";
+
+    MetricsEngine tracks; // c = 10, p = 2
+    std::vector<Body> truth = {Body({0, 0}), Body({50, 50})};
+
+    std::vector<TrackEstimate> perfect = {{50, 50}, {0, 0}};
+    check("Perfect tracks score zero", near(tracks.scoreTracks(perfect, truth), 0.0) && near(tracks.getLastGospa(), 0.0));
+
+    // One exact, one 3 m off, one false track far away
+    std::vector<TrackEstimate> estimate = {{0, 0}, {53, 50}, {-80, 20}};
+    check("OSPA penalizes localization and cardinality",
+          near(tracks.scoreTracks(estimate, truth), std::sqrt((9.0 + 100.0) / 3), 1e-6));
+    check("GOSPA charges half the cutoff per false track", near(tracks.getLastGospa(), std::sqrt(9.0 + 50.0), 1e-6));
+
+    std::vector<TrackEstimate> none;
+    check("No tracks is the cutoff", near(tracks.scoreTracks(none, truth), 10.0));
+    check("GOSPA counts the missed targets", near(tracks.getLastGospa(), std::sqrt(100.0), 1e-6));
+    check("GOSPA totals are accumulated",
+          tracks.getGospaTotals().missed == 2 && tracks.getGospaTotals().false_tracks == 1 && tracks.getOspa().count == 3);
+
+    std::stringstream report;
+    noisy_metrics.report(report);
+    check("Report lists the radar", report.str().find("Radar 0") != std::string::npos);
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
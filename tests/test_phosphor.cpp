@@ -0,0 +1,70 @@
+#include "Phosphor.h"
+#include <iostream>
+#include <cmath>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+int main()
+{
+    std::cout << "\e[1;93m";
+    std::cout << "Return Position Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Detection det;
+    det.detected = true;
+    det.distance = 10.0f;
+    det.azimuth = 90.0f;
+    float x, y;
+    Phosphor::returnPosition(5.0f, -3.0f, det, x, y);
+    check("Return is offset from the radar along its azimuth", std::fabs(x - 5.0f) < 1e-4f && std::fabs(y - 7.0f) < 1e-4f);
+
+    det.azimuth = 225.0f;
+    Phosphor::returnPosition(0.0f, 0.0f, det, x, y);
+    check("Return lands at its measured range", std::fabs(std::hypot(x, y) - 10.0f) < 1e-4f && x < 0 && y < 0);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Decay Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // 60 fps over a 3 s persistence: 1.4 levels a frame, the fractions must not be lost
+    Phosphor::Decay decay(3.0f);
+    int total = 0;
+    bool small_steps = true;
+    for (int frame = 0; frame < 180; frame++)
+    {
+        int level = decay.advance(1.0f / 60);
+        small_steps = small_steps && level <= 2;
+        total += level;
+    }
+    check("Decay is spread over the frames", small_steps);
+    check("Full brightness fades out in the persistence time", total >= 254 && total <= 255);
+
+    // Frames shorter than one level still add up
+    Phosphor::Decay slow(3.0f);
+    int slow_total = 0;
+    for (int frame = 0; frame < 3000; frame++)
+        slow_total += slow.advance(0.001f);
+    check("Sub-level frames carry over", slow_total >= 254 && slow_total <= 255);
+
+    // A long stall clears the layer once, it does not owe extra decay afterwards
+    Phosphor::Decay stalled(3.0f);
+    check("Long frame subtracts everything", stalled.advance(10.0f) == 255);
+    check("Nothing is carried past black", stalled.advance(1.0f / 60) <= 2);
+
+    stalled.advance(0.01f);
+    stalled.reset();
+    check("Reset drops the carried fraction", stalled.advance(0.001f) == 0);
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
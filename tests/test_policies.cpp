@@ -0,0 +1,195 @@
+#include "AnyRadar.h"
+#include "BasicRadar.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+bool same_detections(Span<const Detection> a, Span<const Detection> b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (a[i].target_id != b[i].target_id || a[i].distance != b[i].distance ||
+            a[i].azimuth != b[i].azimuth || a[i].radial_velocity != b[i].radial_velocity ||
+            a[i].timestamp != b[i].timestamp)
+            return false;
+    return true;
+}
+
+std::vector<Body> make_targets(size_t count, unsigned seed)
+{
+    std::default_random_engine rng(seed);
+    std::uniform_real_distribution<float> position(-140.0f, 140.0f);
+    std::uniform_real_distribution<float> velocity(-10.0f, 10.0f);
+    std::vector<Body> targets;
+    for (size_t i = 0; i < count; i++)
+        targets.push_back(Body({position(rng), position(rng)}, {velocity(rng), velocity(rng)}));
+    return targets;
+}
+
+int main()
+{
+    FrameArena arena;
+    const float dt = 0.02f;
+
+    std::cout << "\e[1;93m";
+    std::cout << "Policy Radar Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // A certain, noise-free Radar and the compiled ideal configuration must agree exactly
+    std::vector<Body> targets = make_targets(400, 3);
+    Radar runtime({10, -5}, 120.0f, 0.5f, 8.0f);
+    runtime.setDetectionProb(1.0f);
+    runtime.setNoise(0, 0, 0);
+
+    RadarPolicy::SweptBeam beam;
+    beam.width = 8.0f;
+    beam.revolutions_per_second = 0.5f;
+    IdealRadar ideal({10, -5}, 120.0f, beam);
+
+    bool same = true;
+    size_t plots = 0;
+    float t = 0;
+    for (int s = 0; s < 300; s++)
+    {
+        arena.reset();
+        for (Body &target : targets)
+            target.update(dt);
+        t += dt;
+        runtime.update(dt);
+        ideal.update(dt);
+
+        Span<const Detection> a = runtime.scan(targets, t, arena);
+        Span<const Detection> b = ideal.scan(targets, t, arena);
+        same = same && same_detections(a, b);
+        plots += b.size();
+    }
+    std::cout << "  " << plots << " plots" << std::endl;
+    check("Ideal policy radar matches the runtime radar", same && plots > 0);
+    check("Beam angle follows the runtime radar", std::fabs(ideal.getScanAngle() - runtime.getScanAngle()) < 1e-3f);
+
+    // Noise and Pd policies
+    RadarPolicy::FixedPd pd;
+    pd.pd = 0.5f;
+    RadarPolicy::GaussianNoise noise;
+    noise.range_std = 1.0f;
+    SurveillanceRadar noisy({0, 0}, 150.0f, beam, pd, noise, 7);
+    IdealRadar reference({0, 0}, 150.0f, beam);
+
+    std::vector<Body> still;
+    for (int i = 0; i < 360; i += 10)
+        still.push_back(Body({100.0f * std::cos(i * (float)M_PI / 180), 100.0f * std::sin(i * (float)M_PI / 180)}));
+
+    size_t looks = 0, hits = 0;
+    double error2 = 0;
+    for (int s = 0; s < 2000; s++)
+    {
+        arena.reset();
+        noisy.update(dt);
+        reference.update(dt);
+        Span<const Detection> ref = reference.scan(still, s * dt, arena);
+        Span<const Detection> det = noisy.scan(still, s * dt, arena);
+        looks += ref.size();
+        hits += det.size();
+        for (const Detection &d : det)
+            error2 += (d.distance - 100.0f) * (d.distance - 100.0f);
+    }
+    double rms = std::sqrt(error2 / hits);
+    std::cout << "  " << hits << "/" << looks << " looks detected, range rms " << rms << std::endl;
+    check("Gaussian noise policy has the configured spread", std::fabs(rms - 1.0) < 0.2);
+    check("Fixed Pd policy misses some looks", hits < looks);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Staring Beam Test" << std::endl;
+    std::cout << "\033[0m";
+
+    RadarPolicy::StaringBeam sector;
+    sector.azimuth = 90.0f;
+    sector.width = 65.0f;
+    RadarPolicy::FixedPd certain;
+    certain.pd = 1.0f;
+    RadarPolicy::GaussianNoise quiet;
+    quiet.range_std = quiet.azimuth_std = quiet.velocity_std = 0.0f;
+    StaringRadar staring({0, 0}, 150.0f, sector, certain, quiet);
+
+    arena.reset();
+    staring.update(dt);
+    Span<const Detection> seen = staring.scan(still, 0.0f, arena);
+    bool inside = !seen.empty();
+    for (const Detection &d : seen)
+        inside = inside && d.azimuth > 57.5f && d.azimuth < 122.5f;
+    check("Staring beam only sees its sector", inside && seen.size() == 7);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Type-Erased Radar Test" << std::endl;
+    std::cout << "\033[0m";
+
+    IdealRadar direct({0, 0}, 150.0f, beam);
+    std::vector<AnyRadar> radars;
+    radars.push_back(direct);
+    radars.push_back(staring);
+    radars.push_back(runtime);
+
+    bool forwarded = true;
+    size_t wrapped_plots = 0;
+    for (int s = 0; s < 100; s++)
+    {
+        arena.reset();
+        direct.update(dt);
+        radars[0].update(dt);
+        Span<const Detection> wrapped = radars[0].scan(still, s * dt, arena);
+        forwarded = forwarded && same_detections(direct.scan(still, s * dt, arena), wrapped);
+        wrapped_plots += wrapped.size();
+    }
+    check("Wrapper forwards to the wrapped radar", forwarded && wrapped_plots > 0);
+    check("Wrapper exposes the wrapped radar",
+          radars[0].get<IdealRadar>() != nullptr && radars[0].get<StaringRadar>() == nullptr && radars[2].get<Radar>() != nullptr);
+
+    AnyRadar copy = radars[0];
+    check("Copies are deep", copy.get<IdealRadar>() != radars[0].get<IdealRadar>() &&
+                                 copy.get_max_range() == 150.0f);
+
+    AnyRadar moved = std::move(copy);
+    AnyRadar empty_copy = copy;
+    moved = copy;
+    check("Moved-from wrappers copy as empty", empty_copy.get<IdealRadar>() == nullptr && moved.get<IdealRadar>() == nullptr);
+
+    // Timing for reference only, test builds are not optimized
+    std::vector<Body> crowd = make_targets(20000, 9);
+    Radar general({0, 0}, 120.0f, 0.5f, 8.0f);
+    general.setDetectionProb(1.0f);
+    general.setNoise(0, 0, 0);
+    IdealRadar compiled({0, 0}, 120.0f, beam);
+    double general_ms = 0, compiled_ms = 0;
+    for (int s = 0; s < 20; s++)
+    {
+        arena.reset();
+        general.update(dt);
+        compiled.update(dt);
+        auto t0 = std::chrono::steady_clock::now();
+        general.scan(crowd, s * dt, arena);
+        auto t1 = std::chrono::steady_clock::now();
+        compiled.scan(crowd, s * dt, arena);
+        auto t2 = std::chrono::steady_clock::now();
+        general_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        compiled_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    }
+    std::cout << "  " << general_ms / 20 << " ms runtime radar, " << compiled_ms / 20
+              << " ms ideal policy radar per scan of 20000 targets" << std::endl;
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
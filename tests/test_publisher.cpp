@@ -0,0 +1,193 @@
+#include "PlotPublisher.h"
+#include "Radar.h"
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <dirent.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+Detection make_detection(int i)
+{
+    Detection det;
+    det.detected = true;
+    det.target_id = i;
+    det.timestamp = 10.0f + i * 0.01f;
+    det.distance = 5.0f + i * 0.5f;
+    det.azimuth = fmod(i * 7.3f, 360.0f);
+    det.radial_velocity = -20.0f + i * 0.1f;
+    det.lifespan = 1.0f;
+    return det;
+}
+
+// Receives until expected plots arrived or the socket times out
+std::vector<Detection> receive(int fd, size_t expected, std::vector<uint16_t> &radar_ids)
+{
+    std::vector<Detection> plots;
+    uint8_t buffer[PlotFormat::MAX_BLOCK_SIZE];
+    while (plots.size() < expected)
+    {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+            break;
+        uint16_t radar_id;
+        size_t before = plots.size();
+        if (!PlotFormat::decode(buffer, n, radar_id, plots))
+            break;
+        radar_ids.insert(radar_ids.end(), plots.size() - before, radar_id);
+    }
+    return plots;
+}
+
+void set_timeout(int fd)
+{
+    timeval tv = {2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+bool matches(const Detection &got, const Detection &expected)
+{
+    return got.target_id == expected.target_id &&
+           std::fabs(got.timestamp - expected.timestamp) <= 1.0f / 128 &&
+           std::fabs(got.distance - expected.distance) <= 1.0f / 128 &&
+           std::fabs(got.azimuth - expected.azimuth) <= 360.0f / 65536 &&
+           std::fabs(got.radial_velocity - expected.radial_velocity) <= 1.0f / 16;
+}
+
+int main()
+{
+    const int PLOTS = 500;
+
+    std::cout << "\e[1;93m";
+    std::cout << "Plot Format Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Detection det = make_detection(3);
+    uint8_t block[PlotFormat::MAX_BLOCK_SIZE];
+    size_t size = PlotFormat::encode(7, &det, 1, block);
+    check("Block size", size == PlotFormat::HEADER_SIZE + PlotFormat::RECORD_SIZE);
+
+    std::vector<Detection> decoded;
+    uint16_t radar_id = 0;
+    check("Block decodes", PlotFormat::decode(block, size, radar_id, decoded));
+    check("Radar id round trip", radar_id == 7 && decoded.size() == 1);
+    check("Fields round trip within one LSB", matches(decoded[0], det));
+    block[1] = 0;
+    block[2] = 1;
+    check("Length shorter than the header is rejected", !PlotFormat::decode(block, size, radar_id, decoded));
+    block[0] = 0;
+    check("Wrong category is rejected", !PlotFormat::decode(block, size, radar_id, decoded));
+
+    PlotPublisher unopened;
+    check("Bad ports are rejected", !unopened.open("udp:127.0.0.1:abc") && !unopened.open("udp:127.0.0.1:70000") &&
+                                        !unopened.open("udp:127.0.0.1:") && !unopened.open("udp:127.0.0.1:12x"));
+
+    // Opening again replaces the socket instead of leaking it
+    auto open_fds = []()
+    {
+        size_t count = 0;
+        DIR *dir = opendir("/proc/self/fd");
+        while (dir && readdir(dir))
+            count++;
+        if (dir)
+            closedir(dir);
+        return count;
+    };
+    PlotPublisher reopened;
+    reopened.open("udp:127.0.0.1:9");
+    size_t fds_once = open_fds();
+    bool reopen_ok = reopened.open("udp:127.0.0.1:9") && reopened.open("unix:/tmp/radarsim_none.sock");
+    check("Reopening does not leak descriptors", reopen_ok && open_fds() == fds_once);
+    reopened.start();
+    check("Endpoint cannot change while started", !reopened.open("udp:127.0.0.1:9"));
+    reopened.stop();
+
+    std::cout << "\e[1;93m";
+    std::cout << "UDP Loopback Test" << std::endl;
+    std::cout << "\033[0m";
+
+    int udp = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    int rcvbuf = 1 << 20;
+    setsockopt(udp, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    check("Consumer bound", bind(udp, (sockaddr *)&addr, sizeof(addr)) == 0);
+    socklen_t len = sizeof(addr);
+    getsockname(udp, (sockaddr *)&addr, &len);
+    set_timeout(udp);
+
+    {
+        PlotPublisher publisher;
+        check("Publisher opened", publisher.open("udp:127.0.0.1:" + std::to_string(ntohs(addr.sin_port))));
+        publisher.start();
+        for (int i = 0; i < PLOTS; i++)
+            publisher.publish(i % 2, make_detection(i));
+        publisher.stop();
+        check("All plots sent", publisher.getSentPlots() == PLOTS && publisher.getDroppedPlots() == 0);
+        check("Plots were batched", publisher.getSentDatagrams() < PLOTS);
+    }
+
+    std::vector<uint16_t> radar_ids;
+    std::vector<Detection> plots = receive(udp, PLOTS, radar_ids);
+    check("All plots received", plots.size() == PLOTS);
+
+    // Per radar the plots arrive in publish order
+    int next[2] = {0, 1};
+    bool in_order = true;
+    for (size_t i = 0; i < plots.size(); i++)
+    {
+        uint16_t r = radar_ids[i];
+        in_order = in_order && r < 2 && matches(plots[i], make_detection(next[r]));
+        next[r] += 2;
+    }
+    check("Plots decode in order", in_order);
+    close(udp);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Unix Socket Test" << std::endl;
+    std::cout << "\033[0m";
+
+    std::string path = "/tmp/radarsim_test_" + std::to_string(getpid()) + ".sock";
+    int unix_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un unix_addr = {};
+    unix_addr.sun_family = AF_UNIX;
+    strncpy(unix_addr.sun_path, path.c_str(), sizeof(unix_addr.sun_path) - 1);
+    unlink(path.c_str());
+    check("Unix consumer bound", bind(unix_fd, (sockaddr *)&unix_addr, sizeof(unix_addr)) == 0);
+    set_timeout(unix_fd);
+
+    {
+        PlotPublisher publisher;
+        check("Unix publisher opened", publisher.open("unix:" + path));
+        publisher.start();
+        for (int i = 0; i < 50; i++)
+            publisher.publish(0, make_detection(i));
+        publisher.stop();
+    }
+
+    radar_ids.clear();
+    plots = receive(unix_fd, 50, radar_ids);
+    check("Unix plots received", plots.size() == 50 && matches(plots[49], make_detection(49)));
+    close(unix_fd);
+    unlink(path.c_str());
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
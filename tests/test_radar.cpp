@@ -102,6 +102,66 @@ int main()
     a = radar.calculateAzimuth(target8);
     check_equal("Target8 Azimuth", a, 315.0f);
 
+    // Beam Sweep Test
+    std::cout << "\e[1;93m";
+    std::cout << "Beam Sweep Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // 1 rev/s with 0.25s steps sweeps 90 deg per step, far wider than the 2 deg beam,
+    // so an instantaneous cone test would never see a target at 45 deg
+    Radar sweeping({0, 0}, 50.0f, 1.0f, 2.0f, 0.0f);
+    Body still({10, 10});
+    float dt = 0.25f, t = 0.0f;
+    int hits = 0;
+    for (int i = 0; i < 80; i++)
+    {
+        sweeping.update(dt);
+        t += dt;
+        Detection det = sweeping.scan(still, 0, t);
+        if (det.detected)
+        {
+            hits++;
+            // beam center reaches 45 deg half way through every first-quadrant step
+            check_equal("Static target crossing time", std::fmod(det.timestamp, 1.0f), 0.125f);
+        }
+    }
+    check_equal("Static target detected every revolution", hits > 10, 1.0f);
+
+    // Tangentially moving target, crossing time must account for its motion
+    // Certain and noise-free, so the pass is always detected
+    Radar sweeping2({0, 0}, 50.0f, 1.0f, 2.0f, 0.0f);
+    sweeping2.setDetectionProb(1.0f);
+    sweeping2.setNoise(0, 0, 0);
+    Body mover({20, -10}, {0, 8});
+    t = 0.0f;
+    int crossings = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        mover.update(dt);
+        sweeping2.update(dt);
+        t += dt;
+        Detection det = sweeping2.scan(mover, 0, t);
+        if (!det.detected)
+            continue;
+        crossings++;
+
+        // Reference crossing: bisect beam angle 360t - 360 against the target azimuth
+        float lo = 0.75f, hi = 1.0f;
+        for (int k = 0; k < 40; k++)
+        {
+            float mid = (lo + hi) / 2;
+            float az = std::atan2(-10.0f + 8 * mid, 20.0f) * 180.0f / M_PI;
+            if (360.0f * mid - 360.0f < az)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        check_equal("Moving target crossing time", det.timestamp, lo, 2e-3f);
+        float y = -10.0f + 8 * lo;
+        check_equal("Moving target range at crossing", det.distance, std::sqrt(400.0f + y * y), 2e-2f);
+    }
+    check_equal("Moving target detected once", crossings, 1.0f);
+
     std::cout << "\e[1;92m";
     std::cout << "All tests were successful!\n";
     std::cout << "\033[0m";
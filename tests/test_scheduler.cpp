@@ -0,0 +1,146 @@
+#include "Simulation.h"
+#include "BeamScheduler.h"
+#include <iostream>
+#include <cmath>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+// Deterministic scenario: certain detection and no noise, so both scan modes
+// must report exactly the same detections
+void build(Simulation &sim)
+{
+    Radar radar({0, 0}, 500.0f, 0.5f, 3.0f, 0.0f);
+    radar.setDetectionProb(1.0f);
+    radar.setNoise(0, 0, 0);
+    sim.addRadar(radar);
+
+    Radar fast({50, -30}, 300.0f, 2.0f, 1.0f, 0.0f);
+    fast.setDetectionProb(1.0f);
+    fast.setNoise(0, 0, 0);
+    sim.addRadar(fast);
+
+    unsigned seed = 12345;
+    auto next = [&seed]()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return ((seed >> 16) & 0x7FFF) / 32767.0f;
+    };
+    for (int i = 0; i < 400; i++)
+        sim.addTarget(Body({next() * 600 - 300, next() * 600 - 300},
+                           {next() * 40 - 20, next() * 40 - 20}));
+}
+
+// Targets built with a constant acceleration curve every step without a
+// manoeuvre() call, the scheduler has to allow for that on its own
+void build_accelerating(Simulation &sim)
+{
+    Radar radar({0, 0}, 150.0f);
+    radar.setDetectionProb(1.0f);
+    radar.setNoise(0, 0, 0);
+    sim.addRadar(radar);
+
+    unsigned seed = 777;
+    auto next = [&seed]()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return ((seed >> 16) & 0x7FFF) / 32767.0f;
+    };
+    for (int i = 0; i < 400; i++)
+        sim.addTarget(Body({next() * 280 - 140, next() * 280 - 140},
+                           {next() * 20 - 10, next() * 20 - 10},
+                           {next() * 20 - 10, next() * 20 - 10}));
+}
+
+// Mid-run manoeuvres of every 7th target, the predictions must be refreshed
+void manoeuvre_some(Simulation &sim, int step)
+{
+    if (step != 300 && step != 600)
+        return;
+    for (size_t t = 0; t < sim.getTargets().size(); t += 7)
+        sim.manoeuvre(t, {(float)(t % 5) - 2, step == 300 ? 3.0f : -3.0f});
+}
+
+// Runs both modes side by side, returns whether every step's detections agree.
+// before_step, if set, is applied to both simulations ahead of each step
+bool same_detections(Simulation &full, Simulation &events, int steps, size_t &total,
+                     void (*before_step)(Simulation &, int) = nullptr)
+{
+    for (int s = 0; s < steps; s++)
+    {
+        if (before_step)
+        {
+            before_step(full, s);
+            before_step(events, s);
+        }
+        full.step();
+        events.step();
+        for (size_t r = 0; r < full.getRadars().size(); r++)
+        {
+            Span<const Detection> a = full.getStepDetections(r);
+            Span<const Detection> b = events.getStepDetections(r);
+            if (a.size() != b.size())
+                return false;
+            for (size_t i = 0; i < a.size(); i++)
+                if (a[i].target_id != b[i].target_id || a[i].timestamp != b[i].timestamp)
+                    return false;
+            total += a.size();
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    std::cout << "\e[1;93m";
+    std::cout << "Event Driven Scan Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Simulation full(0.02f), events(0.02f);
+    build(full);
+    build(events);
+    events.setScanMode(ScanMode::EVENT_DRIVEN);
+
+    const int STEPS = 1000;
+    size_t total = 0;
+    bool same = same_detections(full, events, STEPS, total, manoeuvre_some);
+
+    check("Scan produced detections", total > 0);
+    check("Event-driven scan matches full scan", same);
+
+    uint64_t full_evaluations = (uint64_t)STEPS * 2 * 400;
+    uint64_t event_evaluations = events.getScheduler().getEvaluations();
+    std::cout << "  " << event_evaluations << " evaluations vs " << full_evaluations << " for a full scan" << std::endl;
+    check("Event-driven scan evaluates far fewer targets", event_evaluations * 5 < full_evaluations);
+
+    std::cout << "\e[1;93m";
+    std::cout << "Accelerating Targets Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Simulation full_accel(0.02f), events_accel(0.02f);
+    build_accelerating(full_accel);
+    build_accelerating(events_accel);
+    events_accel.setScanMode(ScanMode::EVENT_DRIVEN);
+
+    size_t accel_total = 0;
+    bool accel_same = same_detections(full_accel, events_accel, 3000, accel_total);
+    std::cout << "  " << accel_total << " plots, " << events_accel.getScheduler().getEvaluations() << " evaluations vs "
+              << 3000 * 400 << " for a full scan" << std::endl;
+    check("Event-driven scan matches full scan for accelerating targets", accel_same && accel_total > 0);
+
+    // The acceleration allowance may shorten the waits, but not back to a full scan
+    check("Event-driven scan still skips most accelerating targets",
+          events_accel.getScheduler().getEvaluations() * 5 < (uint64_t)3000 * 400);
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "ShardCluster.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <tuple>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+// Target, time and measured range of a step's plots, in a comparable order
+std::vector<std::tuple<int, float, float>> keys(Span<const Detection> detections)
+{
+    std::vector<std::tuple<int, float, float>> out;
+    for (const Detection &d : detections)
+        out.push_back(std::make_tuple(d.target_id, d.timestamp, d.distance));
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+int main()
+{
+    std::cout << "\e[1;93m";
+    std::cout << "Shard Grid Test" << std::endl;
+    std::cout << "\033[0m";
+
+    ShardGrid grid;
+    grid.min_x = -200;
+    grid.min_y = -200;
+    grid.max_x = 200;
+    grid.max_y = 200;
+    grid.cols = 2;
+    grid.rows = 2;
+
+    check("Points map to their cell", grid.shardOf(-50, -50) == 0 && grid.shardOf(50, -50) == 1 &&
+                                          grid.shardOf(-50, 50) == 2 && grid.shardOf(50, 50) == 3);
+    check("Border cells own everything outside the bounds", grid.shardOf(-1e6f, 1e6f) == 2);
+    check("Circle inside one cell touches only that cell",
+          grid.intersects(3, 100, 100, 50) && !grid.intersects(0, 100, 100, 50) &&
+              !grid.intersects(1, 100, 100, 50) && !grid.intersects(2, 100, 100, 50));
+    check("Circle over the center touches every cell",
+          grid.intersects(0, 0, 0, 10) && grid.intersects(1, 0, 0, 10) &&
+              grid.intersects(2, 0, 0, 10) && grid.intersects(3, 0, 0, 10));
+
+    std::cout << "\e[1;93m";
+    std::cout << "Shard Cluster Test" << std::endl;
+    std::cout << "\033[0m";
+
+    // The same scenario in one process and over four worker processes. Both get
+    // copies of the same radars, RNG included, so they must report identical plots
+    Simulation sim(0.05f);
+    ShardCluster cluster(0.05f, grid);
+    check("Nothing is added before the workers start",
+          cluster.addRadar(Radar({0, 0}, 50.0f)) == ShardCluster::INVALID_ID &&
+              cluster.addTarget(Body({0, 0})) == ShardCluster::INVALID_ID &&
+              cluster.getRadars().empty() && cluster.getTargetCount() == 0);
+    check("Workers started", cluster.start());
+
+    Radar west({-100, -60}, 90.0f, 1.0f, 10.0f);
+    Radar corner({120, 120}, 50.0f, 1.5f, 15.0f);
+    for (Radar *radar : {&west, &corner})
+    {
+        sim.addRadar(*radar);
+        cluster.addRadar(*radar);
+    }
+
+    std::default_random_engine rng(11);
+    std::uniform_real_distribution<float> position(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> velocity(-8.0f, 8.0f);
+    std::vector<Body> targets;
+    for (int i = 0; i < 300; i++)
+        targets.push_back(Body({position(rng), position(rng)}, {velocity(rng), velocity(rng)}));
+    for (const Body &t : targets)
+        sim.addTarget(t);
+    check("Targets get consecutive ids", cluster.addTargets(targets) == 0 && cluster.getTargetCount() == 300);
+
+    bool same = true;
+    bool ordered = true;
+    size_t plots = 0;
+    for (int s = 0; s < 200 && cluster.isRunning(); s++)
+    {
+        sim.step();
+        if (!cluster.step())
+            break;
+
+        for (size_t r = 0; r < 2; r++)
+            same = same && keys(sim.getStepDetections(r)) == keys(cluster.getStepDetections(r));
+
+        Span<const ClusterDetection> merged = cluster.getMergedDetections();
+        for (size_t i = 1; i < merged.size(); i++)
+            ordered = ordered && merged[i - 1].detection.timestamp <= merged[i].detection.timestamp;
+        plots += merged.size();
+    }
+    std::cout << "  " << plots << " plots, " << cluster.getMigrations() << " migrations" << std::endl;
+    check("Cluster kept running", cluster.isRunning());
+    check("Sharded detections match the single process run", same && plots > 0);
+    check("Merged detections are in timestamp order", ordered);
+    check("Targets migrated between shards", cluster.getMigrations() > 0);
+
+    size_t owned = 0;
+    for (size_t s = 0; s < grid.count(); s++)
+        owned += cluster.getShardTargetCount(s);
+    check("Every target is owned by exactly one shard", owned == 300);
+
+    std::vector<Body> gathered;
+    check("Targets gathered", cluster.gather(gathered) && gathered.size() == 300);
+    bool positions = true;
+    for (size_t i = 0; i < gathered.size(); i++)
+        positions = positions && gathered[i].pos_data()[0] == sim.getTargets()[i].pos_data()[0] &&
+                    gathered[i].pos_data()[1] == sim.getTargets()[i].pos_data()[1];
+    check("Sharded targets moved exactly like the single process ones", positions);
+
+    // The west radar reaches the two western shards, the corner one only its own
+    check("Scan fans out only to intersecting shards", cluster.getScanRequests() == 200 * 3);
+
+    cluster.stop();
+    check("Cluster stopped", !cluster.isRunning());
+    check("Nothing is added to a stopped cluster",
+          cluster.addRadar(west) == ShardCluster::INVALID_ID && cluster.addTargets(targets) == ShardCluster::INVALID_ID &&
+              cluster.getTargetCount() == 300);
+
+    check("Restarted cluster is empty", cluster.start() && cluster.getRadars().empty() && cluster.getTargetCount() == 0 &&
+                                            cluster.addTarget(targets[0]) == 0);
+    cluster.stop();
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "SignalProcessor.h"
+#include "Simulation.h"
+#include <chrono>
+#include <iostream>
+#include <cmath>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+const Detection *find_target(Span<const Detection> detections, int target_id)
+{
+    for (const Detection &det : detections)
+        if (det.target_id == target_id)
+            return &det;
+    return nullptr;
+}
+
+int main()
+{
+    FrameArena arena;
+
+    std::cout << "\e[1;93m";
+    std::cout << "Range-Doppler Test" << std::endl;
+    std::cout << "\033[0m";
+
+    SignalProcessor processor(WaveformParams(), 42);
+    float dr = processor.getRangeResolution();
+    float dv = processor.getVelocityResolution();
+
+    Echo single[] = {{60.3f, -20.0f, 7}};
+    Span<const Detection> dets = processor.dwell(Span<const Echo>(single, 1), 30.0f, 1.5f, arena);
+    const Detection *det = find_target(dets, 7);
+    check("Single target detected", det != nullptr);
+    check("Range within half a cell", std::fabs(det->distance - 60.3f) < dr / 2);
+    check("Velocity within one cell", std::fabs(det->radial_velocity + 20.0f) < dv);
+    check("Detection carries beam azimuth and time", det->azimuth == 30.0f && det->timestamp == 1.5f);
+
+    // Same range, resolved in Doppler only
+    arena.reset();
+    Echo pair[] = {{80.0f, 15.0f, 1}, {80.0f, -15.0f, 2}};
+    dets = processor.dwell(Span<const Echo>(pair, 2), 0.0f, 0.0f, arena);
+    check("Targets resolved in Doppler", find_target(dets, 1) && find_target(dets, 2));
+
+    // Noise only, false alarms must stay near the design Pfa
+    size_t false_alarms = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        arena.reset();
+        false_alarms += processor.dwell(Span<const Echo>(), 0.0f, 0.0f, arena).size();
+    }
+    std::cout << "  " << false_alarms << " false alarms in 50 noise-only dwells" << std::endl;
+    check("CA-CFAR false alarms are rare", false_alarms <= 5);
+
+    WaveformParams os_params;
+    os_params.cfar = CfarType::ORDERED_STATISTIC;
+    SignalProcessor os_processor(os_params, 7);
+    arena.reset();
+    dets = os_processor.dwell(Span<const Echo>(single, 1), 0.0f, 0.0f, arena);
+    check("OS-CFAR detects the target", find_target(dets, 7) != nullptr);
+
+    false_alarms = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        arena.reset();
+        false_alarms += os_processor.dwell(Span<const Echo>(), 0.0f, 0.0f, arena).size();
+    }
+    check("OS-CFAR false alarms are rare", false_alarms <= 5);
+
+    // Degenerate settings are clamped to a usable CFAR window instead of reading out of bounds
+    bool clamped = true;
+    for (CfarType type : {CfarType::CELL_AVERAGING, CfarType::ORDERED_STATISTIC})
+    {
+        WaveformParams tiny;
+        tiny.cfar = type;
+        tiny.cfar_train = 0;
+        tiny.num_range_bins = 4;
+        SignalProcessor tiny_processor(tiny, 11);
+        Echo close[] = {{4.0f, 5.0f, 3}};
+        arena.reset();
+        dets = tiny_processor.dwell(Span<const Echo>(close, 1), 0.0f, 0.0f, arena);
+        clamped = clamped && find_target(dets, 3) != nullptr;
+    }
+    check("Degenerate CFAR settings are clamped", clamped);
+
+    // Timing of one dwell, for reference only since test builds are not optimized
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; i++)
+    {
+        arena.reset();
+        processor.dwell(Span<const Echo>(single, 1), 0.0f, 0.0f, arena);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << elapsed.count() / 20 << " ms per dwell" << std::endl;
+
+    std::cout << "\e[1;93m";
+    std::cout << "Signal Model Simulation Test" << std::endl;
+    std::cout << "\033[0m";
+
+    Simulation sim(0.05f);
+    sim.addRadar(Radar({0, 0}, 150.0f, 1.0f, 10.0f));
+    sim.addTarget(Body({50, 50}, {-3, 1}));
+    sim.enableSignalModel(0, WaveformParams(), 3);
+
+    size_t associated = 0;
+    for (int s = 0; s < 40; s++)
+    {
+        sim.step();
+        for (const Detection &d : sim.getStepDetections(0))
+            associated += d.target_id == 0;
+    }
+    check("Signal model feeds the detection pipeline", associated >= 1);
+    check("Radar recorded the detections", !sim.getRadars()[0].getDetections().empty());
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "TrailStore.h"
+#include <iostream>
+#include <cmath>
+
+void check(std::string name, bool condition)
+{
+    if (!condition)
+    {
+        std::cerr << "\033[31m[X]\033[0m " << name << std::endl;
+        std::exit(1);
+    }
+    std::cout << "\033[32m[V]\033[0m " << name << std::endl;
+}
+
+int main()
+{
+    std::cout << "\e[1;93m";
+    std::cout << "Trail Store Test" << std::endl;
+    std::cout << "\033[0m";
+
+    std::vector<Body> targets;
+    targets.push_back(Body({0, 0}, {1, 0}));
+    targets.push_back(Body({5, 5}, {0, -2}));
+
+    TrailStore trails(8, 3);
+    trails.reset(targets);
+    check("Reset fills every slot with the current position",
+          trails.x(7, 1) == 5.0f && trails.y(3, 1) == 5.0f && trails.x(5, 0) == 0.0f);
+
+    // Only every third call samples
+    int written = 0;
+    for (int i = 0; i < 9; i++)
+    {
+        for (Body &t : targets)
+            t.update(1.0f);
+        written += trails.record(targets);
+    }
+    check("Decimation samples every third call", written == 3);
+    check("Head advances once per sample", trails.getHead() == 3);
+    check("Newest sample is the current position",
+          trails.x(trails.getHead(), 0) == targets[0].pos_data()[0] &&
+          trails.y(trails.getHead(), 1) == targets[1].pos_data()[1]);
+    check("Older sample is three steps back",
+          std::fabs(trails.x(2, 0) - (targets[0].pos_data()[0] - 3.0f)) < 1e-4f);
+
+    // Wrap around, the slot after the head is always the oldest
+    for (int i = 0; i < 30; i++)
+    {
+        for (Body &t : targets)
+            t.update(1.0f);
+        trails.record(targets);
+    }
+    size_t head = trails.getHead();
+    size_t oldest = (head + 1) % trails.getLength();
+    check("Ring wraps", head == (3 + 10) % 8);
+    check("Slot after the head is the oldest",
+          std::fabs(trails.x(head, 0) - trails.x(oldest, 0) - 3.0f * (trails.getLength() - 1)) < 1e-3f);
+
+    trails.clear();
+    check("Clear drops the trails", trails.getTargetCount() == 0);
+
+    std::cout << "\e[1;92m";
+    std::cout << "All tests were successful!\n";
+    std::cout << "\033[0m";
+    return 0;
+}